@@ -0,0 +1,93 @@
+#include "AlarmAnimator.h"
+#include "TraceRecorder.h"
+#include <Conveyor/Conveyor_T2K.h>
+
+AlarmAnimator* AlarmAnimator::instance()
+{
+    static AlarmAnimator* animator = new AlarmAnimator();
+    return animator;
+}
+
+AlarmAnimator::AlarmAnimator(QObject *parent)
+    : QObject{parent},
+      m_clock(new QTimer(this)),
+      m_on(false)
+{
+    m_clock->setInterval(ALARM_PHASE_INTERVAL);
+    connect(m_clock, &QTimer::timeout, this, &AlarmAnimator::on_clock);
+}
+
+void AlarmAnimator::addWidget(TrayBase* widget)
+{
+    if (widget->m_alarmIndex >= 0)
+        return;
+
+    widget->m_alarmIndex = m_widgets.size();
+    m_widgets.append(widget);
+    updateClock();
+}
+
+// The last widget takes the place of the removed one, the capacity is kept
+void AlarmAnimator::removeWidget(TrayBase* widget)
+{
+    const int index = widget->m_alarmIndex;
+
+    if (index < 0)
+        return;
+
+    widget->m_alarmIndex = -1;
+
+    TrayBase* last = m_widgets.last();
+    m_widgets.removeLast();
+
+    if (last != widget)
+    {
+        m_widgets[index] = last;
+        last->m_alarmIndex = index;
+    }
+
+    updateClock();
+}
+
+void AlarmAnimator::addView(QObject* view)
+{
+    if (m_views.contains(view))
+        return;
+
+    m_views.append(view);
+    updateClock();
+}
+
+void AlarmAnimator::removeView(QObject* view)
+{
+    if (m_views.removeOne(view))
+        updateClock();
+}
+
+// No wakeup at all without alarm, the phase restarts "on" with the first one
+void AlarmAnimator::updateClock()
+{
+    if (alarmCount() > 0 && !m_clock->isActive())
+    {
+        m_on = true;
+        m_clock->start();
+    }
+    else if (alarmCount() == 0 && m_clock->isActive())
+    {
+        m_clock->stop();
+        m_on = false;
+    }
+}
+
+void AlarmAnimator::on_clock()
+{
+    TRACE_SCOPE("AlarmAnimator::on_clock");
+
+    m_on = !m_on;
+
+    // Qt merges these into a single paint pass per window
+    for (TrayBase* widget : qAsConst(m_widgets))
+        widget->update();
+
+    emit phaseChanged(m_on);
+}
@@ -0,0 +1,58 @@
+#ifndef ALARMANIMATOR_H
+#define ALARMANIMATOR_H
+
+#include <QObject>
+#include <QVector>
+#include <QColor>
+#include <QTimer>
+
+class TrayBase;
+
+//---------------------------------------------------------------------------------------
+// class AlarmAnimator
+// One blink clock for the whole application. Alarmed widgets are kept in a compact
+// array, each widget holding its own position in it, and only they are repainted when
+// the phase flips; views painting their own cells (walls) register once and repaint
+// their alarmed cells on phaseChanged. The clock only runs while something is alarmed.
+// Once the array has grown to the alarm count, adding and removing never allocate.
+//---------------------------------------------------------------------------------------
+
+static const int    ALARM_PHASE_INTERVAL = 500;                         // ms, half a blink period
+static const QColor ALARM_BLINK_COLOR    = QColor(255, 255, 255, 150);  // painted over the cell during the "on" phase
+
+class AlarmAnimator : public QObject
+{
+    Q_OBJECT
+public:
+    static AlarmAnimator* instance();
+
+    bool isOn() const { return m_on; }
+
+    // Widgets blinking as a whole (trays, bucket plates), O(1)
+    void addWidget(TrayBase* widget);
+    void removeWidget(TrayBase* widget);
+
+    // Views drawing several alarmed cells themselves
+    void addView(QObject* view);
+    void removeView(QObject* view);
+
+    int  alarmCount() const { return m_widgets.size() + m_views.size(); }
+
+signals:
+    void phaseChanged(bool on);
+
+private:
+    explicit AlarmAnimator(QObject *parent = nullptr);
+    void updateClock();
+
+private slots:
+    void on_clock();
+
+private:
+    QVector<TrayBase*>    m_widgets;        // each at its TrayBase::m_alarmIndex, for the swap removal
+    QVector<QObject*>     m_views;
+    QTimer*               m_clock;
+    bool                  m_on;
+};
+
+#endif // ALARMANIMATOR_H
@@ -1,29 +1,51 @@
 #include "BasicCarousel.h"
 #include <QHBoxLayout>
+#include <QResizeEvent>
+#include <QPainter>
 #include <QDebug>
+#include <algorithm>
+#include "TraceRecorder.h"
+#include "LabelCache.h"
+#include "StatePalette.h"
 
 static const int ITERATION_NB = 100;
 static const int ITERATION_STEP = 2;
+static const QColor HIGHLIGHT_COLOR = QColor(0x5E,0x96,0xEB);
+static const int RELAYOUT_DELAY = 100;      // ms without a resize before the children are laid out
 
 BasicCarousel::BasicCarousel(const QRect geoRect, const int nbBuckets, QWidget *parent)
     : QWidget{parent},
       NB_BUCKETS(nbBuckets),
-      m_bcsPosition(1),
-      m_previousBcsPosition(0),
-      m_timer(new QTimer(this))
+      m_highlightedId(-1),
+      m_model(new CarouselModel(nbBuckets, this)),
+      m_liveModel(m_model),
+      m_selection(new SelectionModel(nbBuckets, this)),
+      m_clickDispatcher(new BucketClickDispatcher([](QWidget* cell) { return static_cast<BucketPlate*>(cell)->id(); }, this)),
+      m_synoptic(nullptr),
+      m_timer(new QTimer(this)),
+      m_relayoutTimer(new QTimer(this))
 {
     this->setGeometry(geoRect);
 
-    connect(m_timer, &QTimer::timeout, this, &BasicCarousel::on_timer);
+    m_relayoutTimer->setSingleShot(true);
+    m_relayoutTimer->setInterval(RELAYOUT_DELAY);
+    connect(m_relayoutTimer, &QTimer::timeout, this, &BasicCarousel::on_resizeSettled);
 
-    CAROUSEL_CURVES_WIDTH = 0.11*width();
+    connect(m_clickDispatcher, &BucketClickDispatcher::bucketClicked, this, &BasicCarousel::on_bucketClicked);
 
-    CAROUSEL_LINE_HEIGHT = 0.3*height();
+    // The selection is drawn over the state, the model is never modified
+    connect(m_selection, &SelectionModel::selectionChanged, this, &BasicCarousel::on_bucketsChanged);
 
-    CAROUSEL_LINES_SPACING = 0.4*height();
+    connect(m_timer, &QTimer::timeout, this, &BasicCarousel::on_timer);
+    connect(m_model, &CarouselModel::positionChanged, this, &BasicCarousel::updateBuckets);
+    connect(m_model, &CarouselModel::bucketsChanged, this, &BasicCarousel::on_bucketsChanged);
+
+    computeGeometry();
 
     m_synoptic = createSynopticView();
 
+    applyGeometry();
+
     setInitialState();
 
     m_timer->setInterval(2000);
@@ -31,71 +53,253 @@ BasicCarousel::BasicCarousel(const QRect geoRect, const int nbBuckets, QWidget *
 }
 
 
+// Shows another model with the same bucket count (history, replay), the model is not owned
+void BasicCarousel::setModel(CarouselModel* model)
+{
+    if (model == m_model || model->bucketCount() != NB_BUCKETS)
+        return;
+
+    disconnect(m_model, nullptr, this, nullptr);
+
+    m_model = model;
+
+    connect(m_model, &CarouselModel::positionChanged, this, &BasicCarousel::updateBuckets);
+    connect(m_model, &CarouselModel::bucketsChanged, this, &BasicCarousel::on_bucketsChanged);
+
+    updateBuckets();
+    emit modelChanged(m_model);
+}
+
+
+// Rebuilds every slot from the model after a rotation
 void BasicCarousel::updateBuckets()
 {
-    m_buffer.clear();
-    BucketPlateData data;
+    TRACE_SCOPE("BasicCarousel::updateBuckets");
 
-    // WARNING : Each iteration is building up from previous iteration
-    // Need offset from previous iteration
-    int posOffset = m_bcsPosition - m_previousBcsPosition;
-    //qDebug() <<"Pos offset: "<< posOffset;
+    for (int i = 0; i < m_buckets.size(); i++)
+        refreshSlot(i);
+}
 
-    for (int i = 0; i < NB_BUCKETS; i++)
-    {
-        // a[(index+offset)%N] - circular buffer
-        data.state = m_buckets[(i+posOffset-1)%NB_BUCKETS]->state();
-        data.id = m_buckets[(i+posOffset-1)%NB_BUCKETS]->id();
 
-        m_buffer.append(data);
-    }
+void BasicCarousel::refreshSlot(int slot)
+{
+    BucketPlate* bucket = m_buckets[slot];
+    const int id = m_model->idAtSlot(slot);
+
+    bucket->setId(id);
+    bucket->setText(LabelCache::number(id), false, false);
+    bucket->showState(m_model->state(id));
+
+    // Operator attention : blinks with the shared alarm clock
+    bucket->setAlarmed(StatePalette::isAlarm(m_model->state(id)));
+
+    if (id == m_highlightedId || m_selection->isSelected(id))
+        bucket->setColor(HIGHLIGHT_COLOR);
+}
+
+
+void BasicCarousel::on_bucketsChanged(int first, int last)
+{
+    TRACE_SCOPE("BasicCarousel::on_bucketsChanged");
+
+    for (int id = first; id <= last; id++)
+        refreshSlot(m_model->slotOf(id));
+}
+
+
+void BasicCarousel::highlightBucket(int id)
+{
+    const int previousId = m_highlightedId;
+    m_highlightedId = id;
+
+    if (previousId >= 0 && previousId < NB_BUCKETS)
+        refreshSlot(m_model->slotOf(previousId));
+
+    if (id >= 0 && id < NB_BUCKETS)
+        refreshSlot(m_model->slotOf(id));
+}
+
+
+bool BasicCarousel::highlightParcel(const QString& parcelId)
+{
+    const int id = m_model->bucketOfParcel(parcelId);
+
+    if (id < 0)
+        return false;
+
+    highlightBucket(id);
+    return true;
+}
+
+
+void BasicCarousel::on_timer()
+{
+    if(m_liveModel->position() < ITERATION_NB)
+        m_liveModel->setPosition(m_liveModel->position() + ITERATION_STEP);
+
+    // The demo rotation is over : no more wakeups
+    if(m_liveModel->position() >= ITERATION_NB)
+        m_timer->stop();
+}
+
+void BasicCarousel::on_bucketClicked(int id, ConveyorSide side, ConveyorLevel level, Qt::KeyboardModifiers modifiers)
+{
+    Q_UNUSED(side);
+    Q_UNUSED(level);
+    m_selection->click(id, modifiers);
+}
+
+
+// Every size derives from the widget size, recomputed on each relayout
+void BasicCarousel::computeGeometry()
+{
+    CAROUSEL_CURVES_WIDTH = 0.11*width();
+
+    CAROUSEL_LINE_HEIGHT = 0.3*height();
+
+    CAROUSEL_LINES_SPACING = 0.4*height();
+
+    // Calculate available space for bucket width
+    m_bucketsAvailableWidth =  width()-2*CAROUSEL_CURVES_WIDTH;
+
+    // BUCKET_WIDTH is always rounded down, the back line has the most buckets
+    BUCKET_WIDTH = m_bucketsAvailableWidth/((NB_BUCKETS + 1)/2);
+}
+
+
+// Resizes the existing children to the current geometry, nothing is created
+void BasicCarousel::applyGeometry()
+{
+    m_leftCurves->setDistBetweenCircles(CAROUSEL_LINE_HEIGHT-2);
+    m_leftCurves->setFixedSize(CAROUSEL_CURVES_WIDTH , CAROUSEL_LINE_HEIGHT*2 + CAROUSEL_LINES_SPACING);
+    m_rightCurves->setDistBetweenCircles(CAROUSEL_LINE_HEIGHT-2);
+    m_rightCurves->setFixedSize(CAROUSEL_CURVES_WIDTH , CAROUSEL_LINE_HEIGHT*2 + CAROUSEL_LINES_SPACING);
+
+    const int nbFront = NB_BUCKETS/2;
+
+    // Front plates are stored left to right, back plates right to left
+    QVector<BucketPlate*> backLine(m_buckets.size() - nbFront);
+    std::reverse_copy(m_buckets.cbegin() + nbFront, m_buckets.cend(), backLine.begin());
+
+    sizeLine(m_buckets.mid(0, nbFront));
+    sizeLine(backLine);
 
-    for(int i = 0; i< m_buckets.size(); i++)
+    m_synoptic->setMaximumSize(width() , 2*CAROUSEL_LINE_HEIGHT + CAROUSEL_LINES_SPACING);
+    m_synoptic->adjustSize();
+}
+
+
+void BasicCarousel::sizeLine(const QVector<BucketPlate*>& plates)
+{
+    int bucketWidth;
+
+    LINE_WIDTH = 0;
+
+    // BUCKET_WIDTH is always rounded down, so the amount of unused space is less than 1 pixel for each bucket
+    // The remaining width from rounding down may be used to increase the width with 1px for a number of buckets
+    int nb_oversizeBuckets =  m_bucketsAvailableWidth - BUCKET_WIDTH*plates.size();
+
+    for (BucketPlate* bucket : plates)
     {
-        m_buckets[i]->setId( m_buffer[i].id);
-        m_buckets[i]->setText(QString::number(m_buckets[i]->id()),false,true);
-        m_buckets[i]->setState( m_buffer[i].state);
-        //m_buckets[i]->repaint();
+        if (nb_oversizeBuckets > 0)
+        {
+            bucketWidth = BUCKET_WIDTH + 1;
+            nb_oversizeBuckets--;
+        }
+        else
+            bucketWidth = BUCKET_WIDTH;
+
+        bucket->setFixedSize(bucketWidth, CAROUSEL_LINE_HEIGHT);
+
+        LINE_WIDTH += bucketWidth;
     }
 }
 
 
-void BasicCarousel::on_timer()
+void BasicCarousel::relayout()
+{
+    TRACE_SCOPE("BasicCarousel::relayout");
+
+    computeGeometry();
+    applyGeometry();
+}
+
+
+// Debounced during a live drag : the synoptic is grabbed once and only its picture is
+// stretched to the new sizes, the children are laid out once no resize came for
+// RELAYOUT_DELAY. A hidden carousel is laid out at once
+void BasicCarousel::resizeEvent(QResizeEvent *event)
 {
-    if(m_bcsPosition < ITERATION_NB)
+    QWidget::resizeEvent(event);
+
+    if (!m_synoptic || !event->oldSize().isValid())
+        return;
+
+    if (!isVisible())
+    {
+        relayout();
+        return;
+    }
+
+    if (m_resizePreview.isNull())
     {
-        m_bcsPosition += ITERATION_STEP;
-        updateBuckets();
-        m_previousBcsPosition = m_bcsPosition;
+        const QRectF geometry = m_synoptic->geometry();
+        const QSizeF oldSize = event->oldSize();
+
+        m_resizePreview = m_synoptic->grab();
+        m_previewGeometry = QRectF(geometry.x()/oldSize.width(), geometry.y()/oldSize.height(),
+                                   geometry.width()/oldSize.width(), geometry.height()/oldSize.height());
+        m_synoptic->hide();
     }
+
+    m_relayoutTimer->start();
+    update();
 }
 
-void BasicCarousel::on_plateClicked(int id)
+
+void BasicCarousel::on_resizeSettled()
 {
-    qDebug() <<"Selected id: "<< id;
+    relayout();
+
+    m_resizePreview = QPixmap();
+    m_synoptic->show();
+    update();
+}
+
+
+// Only draws the stretched synoptic of a live drag, the children paint everything else
+void BasicCarousel::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    if (m_resizePreview.isNull())
+        return;
+
+    const QRectF target(m_previewGeometry.x()*width(), m_previewGeometry.y()*height(),
+                        m_previewGeometry.width()*width(), m_previewGeometry.height()*height());
+
+    QPainter painter(this);
+    painter.drawPixmap(target, m_resizePreview, m_resizePreview.rect());
 }
 
 
 void BasicCarousel::setInitialState()
 {
-    int index = 0;
     int rnd = 0;
 
-    for(auto bucket: qAsConst(m_buckets))
+    for(int id = 0; id < NB_BUCKETS; id++)
     {
         rnd = std::rand()%100;
 
         if (rnd > 60)
-            bucket->setState(BucketState::SORTED);
+            m_model->setState(id, BucketState::SORTED);
         else if (rnd<10)
-            bucket->setState(BucketState::FAILURE);
+            m_model->setState(id, BucketState::FAILURE);
         else if (rnd>10 && rnd<20)
-            bucket->setState(BucketState::REJECTED);
-
-        bucket->setId(index);
-        bucket->setText(QString::number(bucket->id()));
-        index++;
+            m_model->setState(id, BucketState::REJECTED);
     }
+
+    updateBuckets();
 }
 
 
@@ -103,18 +307,14 @@ QWidget* BasicCarousel::createSynopticView()
 {
     QWidget* synopticView = new QWidget(this);
     synopticView->setStyleSheet("border: 1px solid black");
-    synopticView->setMaximumSize(width() , 2*CAROUSEL_LINE_HEIGHT + CAROUSEL_LINES_SPACING);
 
     QHBoxLayout* synopticViewLayout = new QHBoxLayout(synopticView);
     synopticViewLayout->setMargin(0);
     synopticViewLayout->setSpacing(0);
     synopticView->setLayout(synopticViewLayout);
 
-    // Calculate available space for bucket width
     int upperBackNr, upperFrontNr;
 
-    m_bucketsAvailableWidth =  width()-2*CAROUSEL_CURVES_WIDTH;
-
     upperFrontNr = NB_BUCKETS/2;
 
     if (NB_BUCKETS % 2 == 0)
@@ -122,20 +322,15 @@ QWidget* BasicCarousel::createSynopticView()
     else
         upperBackNr = NB_BUCKETS/2 + 1;
 
-    // BUCKET_WIDTH is always rounded down
-    BUCKET_WIDTH = m_bucketsAvailableWidth/upperBackNr;
-
-    // Create the two lines
+    // Create the two lines, sizes are set by applyGeometry()
     // IMPORTANT : The creation order is important
     m_frontLine = createCarouselLine( upperFrontNr, ConveyorSide::FRONT );
     m_backLine = createCarouselLine( upperBackNr, ConveyorSide::BACK);
 
-    SemicircleWidget* leftCurves = new SemicircleWidget(synopticView, CAROUSEL_LINE_HEIGHT-2, true);
-    leftCurves->setFixedSize(CAROUSEL_CURVES_WIDTH , CAROUSEL_LINE_HEIGHT*2 + CAROUSEL_LINES_SPACING);
-    leftCurves->setColor(QColor(170,170,170,255));
-    SemicircleWidget* rightCurves = new SemicircleWidget(synopticView, CAROUSEL_LINE_HEIGHT-2);
-    rightCurves->setFixedSize(CAROUSEL_CURVES_WIDTH , CAROUSEL_LINE_HEIGHT*2 + CAROUSEL_LINES_SPACING);
-    rightCurves->setColor(QColor(170,170,170,255));
+    m_leftCurves = new SemicircleWidget(synopticView, CAROUSEL_LINE_HEIGHT-2, true);
+    m_leftCurves->setColor(QColor(170,170,170,255));
+    m_rightCurves = new SemicircleWidget(synopticView, CAROUSEL_LINE_HEIGHT-2);
+    m_rightCurves->setColor(QColor(170,170,170,255));
 
     QVBoxLayout* linesLayout = new QVBoxLayout();
     linesLayout->setMargin(0);
@@ -146,9 +341,9 @@ QWidget* BasicCarousel::createSynopticView()
     linesLayout->addStretch(10);
     linesLayout->addWidget(m_frontLine);
 
-    synopticViewLayout->addWidget(leftCurves);
+    synopticViewLayout->addWidget(m_leftCurves);
     synopticViewLayout->addLayout(linesLayout);
-    synopticViewLayout->addWidget(rightCurves);
+    synopticViewLayout->addWidget(m_rightCurves);
 
     return synopticView;
 }
@@ -157,14 +352,6 @@ QWidget* BasicCarousel::createSynopticView()
 // Creates a line composed of buckets
 QWidget* BasicCarousel::createCarouselLine(int nb_buckets, ConveyorSide side)
 {
-    int bucketWidth;
-
-    LINE_WIDTH = 0;
-
-    // BUCKET_WIDTH is always rounded down, so the amount of unused space is less than 1 pixel for each bucket
-    // The remaining width from rounding down may be used to increase the width with 1px for a number of buckets
-    int nb_oversizeBuckets =  m_bucketsAvailableWidth - BUCKET_WIDTH*nb_buckets;
-
     QWidget* carouselLineWidget = new QWidget(this);
     carouselLineWidget->setContentsMargins(0,0,0,0);
     carouselLineWidget->setLayout(new QHBoxLayout());
@@ -172,24 +359,12 @@ QWidget* BasicCarousel::createCarouselLine(int nb_buckets, ConveyorSide side)
     carouselLineWidget->layout()->setMargin(0);
 
     QVector<BucketPlate*> buckets;
+    QVector<QWidget*> cells;        // left to right, for the click dispatcher
 
     for (int i=0; i < nb_buckets; i++)
     {
         BucketPlate* bucket = new BucketPlate(this);
 
-        if (nb_oversizeBuckets > 0 || nb_oversizeBuckets > nb_buckets)
-        {
-            bucketWidth = BUCKET_WIDTH + 1;
-            nb_oversizeBuckets--;
-        }
-        else
-            bucketWidth = BUCKET_WIDTH;
-
-        bucket->setFixedHeight(CAROUSEL_LINE_HEIGHT);
-        bucket->setFixedWidth(bucketWidth);
-
-        LINE_WIDTH += bucketWidth;
-
         if(i == nb_buckets-1)
             bucket->setIsLast(true);
 
@@ -203,11 +378,13 @@ QWidget* BasicCarousel::createCarouselLine(int nb_buckets, ConveyorSide side)
         else
             buckets.push_back(bucket);
 
-        connect(bucket, &BucketPlate::clickReleased, this, &BasicCarousel::on_plateClicked);
-
+        cells.append(bucket);
     }
 
     m_buckets.append(buckets);
 
+    // Clicks are resolved by the line, no connection per bucket
+    m_clickDispatcher->addLine(carouselLineWidget, cells, side, ConveyorLevel::UPPER);
+
     return carouselLineWidget;
 }
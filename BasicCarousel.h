@@ -5,12 +5,10 @@
 #include <QWidget>
 #include <Conveyor/Conveyor_T2K.h>
 #include <QTimer>
-
-struct BucketPlateData
-{
-    int id;
-    BucketState state;
-};
+#include <QPixmap>
+#include "CarouselModel.h"
+#include "SelectionModel.h"
+#include "BucketClickDispatcher.h"
 
 class BasicCarousel : public QWidget
 {
@@ -18,16 +16,40 @@ class BasicCarousel : public QWidget
 public:
     explicit BasicCarousel(const QRect geoRect,const int nbBuckets, QWidget *parent = nullptr);
 
+    CarouselModel* model() const { return m_model; }
+    void           setModel(CarouselModel* model);
+
     void updateBuckets();
 
+    // One bit per bucket id, owned
+    SelectionModel* selectionModel() const { return m_selection; }
+
+    void highlightBucket(int id);
+    bool highlightParcel(const QString& parcelId);
+
+signals:
+    // The live, history or replay model is now shown
+    void modelChanged(CarouselModel* model);
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
 private slots:
     void on_timer();
-    void on_plateClicked(int id);
+    void on_resizeSettled();
+    void on_bucketClicked(int id, ConveyorSide side, ConveyorLevel level, Qt::KeyboardModifiers modifiers);
+    void on_bucketsChanged(int first, int last);
 
 private:
     QWidget* createSynopticView ();
     QWidget* createCarouselLine(int nb_buckets, ConveyorSide side);
     void     setInitialState();
+    void     computeGeometry();
+    void     applyGeometry();
+    void     sizeLine(const QVector<BucketPlate*>& plates);
+    void     relayout();
+    void     refreshSlot(int slot);
 
 private:
     int   NB_BUCKETS;
@@ -37,21 +59,32 @@ private:
     int   CAROUSEL_LINE_HEIGHT;
     int   CAROUSEL_LINES_SPACING;
 
-    int   m_bcsPosition;
-    int   m_previousBcsPosition;
-
     int   m_bucketsAvailableWidth;
+    int   m_highlightedId;
 
+    CarouselModel* m_model;
+    CarouselModel* m_liveModel;     // owned, driven by the timer
+    SelectionModel* m_selection;
+    BucketClickDispatcher* m_clickDispatcher;
+
+    // Indexed by visual slot, the bucket shown in a slot is given by the model head offset
     QVector<BucketPlate*> m_buckets;
-    QVector<BucketPlateData>  m_buffer;
     QWidget*       m_backLine;
     QWidget*       m_frontLine;
 
+    SemicircleWidget* m_leftCurves;
+    SemicircleWidget* m_rightCurves;
+
     QWidget*       m_synoptic;
     QWidget*       m_synopticContainer;
 
     QWidget*       m_zoomHandle;
     QTimer*        m_timer;
+
+    // Live window drag : the last laid out synoptic, stretched until the size settles
+    QTimer*        m_relayoutTimer;
+    QPixmap        m_resizePreview;
+    QRectF         m_previewGeometry;   // of the synoptic, in fractions of the widget size
 };
 
 #endif // BASICCAROUSEL_H
@@ -0,0 +1,109 @@
+#include "BucketClickDispatcher.h"
+#include "RectangleWidget.h"
+#include <algorithm>
+
+static const QColor PRESSED_COLOR = QColor("#5EA9F3");
+
+BucketClickDispatcher::BucketClickDispatcher(IdResolver resolver, QObject *parent)
+    : QObject{parent},
+      m_resolver(resolver),
+      m_pressedCell(nullptr)
+{
+}
+
+void BucketClickDispatcher::addLine(QWidget* line, const QVector<QWidget*>& cells, ConveyorSide side, ConveyorLevel level)
+{
+    for (QWidget* cell : cells)
+        cell->setAttribute(Qt::WA_TransparentForMouseEvents);
+
+    m_lines.append({line, cells, side, level});
+    line->installEventFilter(this);
+}
+
+// Cells are laid out left to right without overlap : binary search on their right edge
+QWidget* BucketClickDispatcher::cellAt(const Line& line, int x) const
+{
+    auto it = std::lower_bound(line.cells.cbegin(), line.cells.cend(), x,
+                               [](QWidget* cell, int x) { return cell->geometry().right() < x; });
+
+    if (it == line.cells.cend() || (*it)->geometry().left() > x)
+        return nullptr;
+
+    return *it;
+}
+
+QWidget* BucketClickDispatcher::cellAt(QWidget* line, int x) const
+{
+    for (const Line& registered : m_lines)
+    {
+        if (registered.widget == line)
+            return cellAt(registered, x);
+    }
+
+    return nullptr;
+}
+
+// Same feedback as a pressed TrayBase or RectangleWidget, restored on release
+void BucketClickDispatcher::setPressed(QWidget* cell)
+{
+    QWidget* previous = m_pressedCell;
+    m_pressedCell = cell;
+
+    QWidget* target = cell ? cell : previous;
+    const QColor color = cell ? PRESSED_COLOR : m_pressedColor;
+
+    if (!target)
+        return;
+
+    if (TrayBase* tray = qobject_cast<TrayBase*>(target))
+    {
+        if (cell)
+            m_pressedColor = tray->color();
+        tray->setColor(color);
+    }
+    else if (RectangleWidget* rectangle = qobject_cast<RectangleWidget*>(target))
+    {
+        if (cell)
+            m_pressedColor = rectangle->color();
+        rectangle->setColor(color);
+    }
+}
+
+bool BucketClickDispatcher::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() != QEvent::MouseButtonPress && event->type() != QEvent::MouseButtonRelease)
+        return QObject::eventFilter(watched, event);
+
+    QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+
+    if (mouseEvent->button() != Qt::LeftButton)
+        return QObject::eventFilter(watched, event);
+
+    for (const Line& line : qAsConst(m_lines))
+    {
+        if (line.widget != watched)
+            continue;
+
+        if (event->type() == QEvent::MouseButtonPress)
+        {
+            QWidget* cell = cellAt(line, mouseEvent->pos().x());
+
+            if (cell)
+                setPressed(cell);
+
+            return cell != nullptr;
+        }
+
+        // The release goes to the line which got the press, wherever the cursor is
+        QWidget* cell = m_pressedCell;
+
+        if (!cell || !line.cells.contains(cell))
+            return false;
+
+        setPressed(nullptr);
+        emit bucketClicked(m_resolver(cell), line.side, line.level, mouseEvent->modifiers());
+        return true;
+    }
+
+    return QObject::eventFilter(watched, event);
+}
@@ -0,0 +1,58 @@
+#ifndef BUCKETCLICKDISPATCHER_H
+#define BUCKETCLICKDISPATCHER_H
+
+#include <QObject>
+#include <QVector>
+#include <QMouseEvent>
+#include <functional>
+#include <Conveyor/Conveyor_T2K.h>
+
+//---------------------------------------------------------------------------------------
+// class BucketClickDispatcher
+// One event filter per carousel line instead of one connection per bucket widget.
+// The cells are transparent for the mouse : the line receives the click, the cell is
+// found from the coordinates and a single typed signal is emitted.
+//---------------------------------------------------------------------------------------
+
+class BucketClickDispatcher : public QObject
+{
+    Q_OBJECT
+public:
+    // Bucket id currently shown by a cell
+    typedef std::function<int(QWidget* cell)> IdResolver;
+
+    explicit BucketClickDispatcher(IdResolver resolver, QObject *parent = nullptr);
+
+    // Cells ordered from left to right, made transparent for mouse events
+    void addLine(QWidget* line, const QVector<QWidget*>& cells, ConveyorSide side, ConveyorLevel level);
+
+    // Cell of a registered line at a horizontal position of the line, nullptr if none
+    QWidget* cellAt(QWidget* line, int x) const;
+
+signals:
+    void bucketClicked(int id, ConveyorSide side, ConveyorLevel level, Qt::KeyboardModifiers modifiers);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Line
+    {
+        QWidget*          widget;
+        QVector<QWidget*> cells;
+        ConveyorSide      side;
+        ConveyorLevel     level;
+    };
+
+    QWidget* cellAt(const Line& line, int x) const;
+    void     setPressed(QWidget* cell);
+
+private:
+    IdResolver      m_resolver;
+    QVector<Line>   m_lines;
+
+    QWidget*        m_pressedCell;
+    QColor          m_pressedColor;
+};
+
+#endif // BUCKETCLICKDISPATCHER_H
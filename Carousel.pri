@@ -0,0 +1,92 @@
+# Sources of the HMI, shared by the application (Carousel.pro) and the test targets (tests/)
+
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+# Render pool of the dashboard
+QT += concurrent
+
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/AlarmAnimator.cpp \
+    $$PWD/BasicCarousel.cpp \
+    $$PWD/BucketClickDispatcher.cpp \
+    $$PWD/CarouselDashboard.cpp \
+    $$PWD/CarouselHistory.cpp \
+    $$PWD/CarouselModel.cpp \
+    $$PWD/CarouselRenderer.cpp \
+    $$PWD/ContainerWall.cpp \
+    $$PWD/Conveyor/Conveyor_T2K.cpp \
+    $$PWD/ConveyorModel.cpp \
+    $$PWD/ConveyorSnapshot.cpp \
+    $$PWD/FrameScheduler.cpp \
+    $$PWD/HistoryScrubber.cpp \
+    $$PWD/IntervalSet.cpp \
+    $$PWD/LabelCache.cpp \
+    $$PWD/OutputWall.cpp \
+    $$PWD/PaintProfiler.cpp \
+    $$PWD/PaintProfilerOverlay.cpp \
+    $$PWD/RectangleWidget.cpp \
+    $$PWD/SelectionModel.cpp \
+    $$PWD/SemicircleWidgetAlt.cpp \
+    $$PWD/SharedBucketChannel.cpp \
+    $$PWD/SingleLevelCarousel.cpp \
+    $$PWD/SorterSimulator.cpp \
+    $$PWD/StallWatchdog.cpp \
+    $$PWD/StatePalette.cpp \
+    $$PWD/SynopticExporter.cpp \
+    $$PWD/TelegramDecoder.cpp \
+    $$PWD/TraceRecorder.cpp \
+    $$PWD/TransitionRecorder.cpp \
+    $$PWD/TransitionReplayer.cpp \
+    $$PWD/TrayWall.cpp \
+    $$PWD/WakeupMeter.cpp \
+    $$PWD/ZoomWindowWidget.cpp \
+    $$PWD/MainWindow.cpp
+
+HEADERS += \
+    $$PWD/AlarmAnimator.h \
+    $$PWD/BasicCarousel.h \
+    $$PWD/BucketClickDispatcher.h \
+    $$PWD/CarouselDashboard.h \
+    $$PWD/CarouselHistory.h \
+    $$PWD/CarouselModel.h \
+    $$PWD/CarouselRenderer.h \
+    $$PWD/ContainerWall.h \
+    $$PWD/Conveyor/Conveyor_T2K.h \
+    $$PWD/ConveyorModel.h \
+    $$PWD/ConveyorSnapshot.h \
+    $$PWD/FrameScheduler.h \
+    $$PWD/HistoryScrubber.h \
+    $$PWD/IntervalSet.h \
+    $$PWD/LabelCache.h \
+    $$PWD/MainWindow.h \
+    $$PWD/OutputWall.h \
+    $$PWD/PaintProfiler.h \
+    $$PWD/PaintProfilerOverlay.h \
+    $$PWD/RectangleWidget.h \
+    $$PWD/SelectionModel.h \
+    $$PWD/SemicircleWidgetAlt.h \
+    $$PWD/SharedBucketChannel.h \
+    $$PWD/SingleLevelCarousel.h \
+    $$PWD/SorterSimulator.h \
+    $$PWD/StallWatchdog.h \
+    $$PWD/StatePalette.h \
+    $$PWD/SynopticExporter.h \
+    $$PWD/TelegramDecoder.h \
+    $$PWD/TraceRecorder.h \
+    $$PWD/TransitionRecorder.h \
+    $$PWD/TransitionReplayer.h \
+    $$PWD/TrayWall.h \
+    $$PWD/WakeupMeter.h \
+    $$PWD/ZoomWindowWidget.h
+
+# POSIX shared memory of the gateway channel
+unix:!macx: LIBS += -lrt
+
+RESOURCES += \
+    $$PWD/resources.qrc
@@ -0,0 +1,216 @@
+#include "CarouselDashboard.h"
+#include "PaintProfiler.h"
+#include "TraceRecorder.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+static const int DASHBOARD_MARGIN = 6;
+
+CarouselDashboard::CarouselDashboard(QWidget *parent)
+    : QWidget{parent},
+      m_scheduler(new FrameScheduler(DASHBOARD_FRAME_INTERVAL, 0, this)),
+      m_columns(2),
+      m_titleHeight(18),
+      m_renderCount(0)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    // The GUI thread keeps a core for the event loop and the blits
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+
+    connect(m_scheduler, &FrameScheduler::frame, this, &CarouselDashboard::on_frame);
+
+    m_clock.start();
+}
+
+// The jobs only hold copies of the scenes and states, they just have to finish
+CarouselDashboard::~CarouselDashboard()
+{
+    m_pool.waitForDone();
+}
+
+int CarouselDashboard::addCarousel(CarouselModel* model, const QString& title)
+{
+    const int index = m_carousels.size();
+
+    Carousel carousel;
+    carousel.model      = model;
+    carousel.title      = title;
+    carousel.dirty      = false;
+    carousel.dirtySince = 0;
+    carousel.watcher    = new QFutureWatcher<QImage>(this);
+
+    connect(carousel.watcher, &QFutureWatcherBase::finished, this, [this, index]() { on_renderFinished(index); });
+
+    // Any change only marks the carousel, the frame clock decides when it is drawn
+    connect(model, &CarouselModel::bucketsChanged, this, [this, index]() { markDirty(index); });
+    connect(model, &CarouselModel::positionChanged, this, [this, index]() { markDirty(index); });
+
+    m_carousels.append(carousel);
+
+    layoutCarousels();
+    return index;
+}
+
+void CarouselDashboard::setColumnCount(int columns)
+{
+    m_columns = qMax(columns, 1);
+    layoutCarousels();
+}
+
+void CarouselDashboard::markDirty(int index)
+{
+    Carousel& carousel = m_carousels[index];
+
+    if (!carousel.dirty)
+    {
+        carousel.dirty = true;
+        carousel.dirtySince = m_clock.elapsed();
+    }
+
+    m_scheduler->wake();
+}
+
+bool CarouselDashboard::isShown(const Carousel& carousel) const
+{
+    return isVisible() && !window()->isMinimized() && visibleRegion().intersects(carousel.rect);
+}
+
+// Hidden carousels stay dirty and are rendered when they are shown again
+void CarouselDashboard::on_frame()
+{
+    TRACE_SCOPE("CarouselDashboard::on_frame");
+
+    QVector<int> candidates;
+    int inFlight = 0;
+
+    for (int i = 0; i < m_carousels.size(); i++)
+    {
+        const Carousel& carousel = m_carousels[i];
+
+        if (carousel.watcher->isRunning())
+            inFlight++;
+        else if (carousel.dirty && isShown(carousel))
+            candidates.append(i);
+    }
+
+    // Nothing to do : the clock stops until the next change
+    if (candidates.isEmpty() && inFlight == 0)
+        return;
+
+    m_scheduler->markBusy();
+
+    // The longest waiting first, so a busy sorter cannot starve a quiet one
+    std::sort(candidates.begin(), candidates.end(),
+              [this](int a, int b) { return m_carousels[a].dirtySince < m_carousels[b].dirtySince; });
+
+    for (int index : qAsConst(candidates))
+    {
+        if (inFlight >= m_pool.maxThreadCount())
+            break;
+
+        startRender(index);
+        inFlight++;
+    }
+}
+
+void CarouselDashboard::startRender(int index)
+{
+    Carousel& carousel = m_carousels[index];
+    const CarouselScene scene = m_renderer.scene(carousel.rect.size(), carousel.model->bucketCount());
+
+    carousel.dirty = false;
+
+    if (!scene.isValid())
+        return;
+
+    // Shared copy of the packed array : the next model write detaches, the job keeps this instant
+    const QVector<quint8> states = carousel.model->states();
+    const int headOffset = carousel.model->headOffset();
+
+    carousel.watcher->setFuture(QtConcurrent::run(&m_pool, [scene, states, headOffset]()
+    {
+        return CarouselRenderer::render(scene, states, headOffset);
+    }));
+}
+
+void CarouselDashboard::on_renderFinished(int index)
+{
+    Carousel& carousel = m_carousels[index];
+
+    // A frame of the previous size is still shown, scaled, until the next one
+    carousel.frame = carousel.watcher->result();
+    m_renderCount++;
+
+    update(carousel.rect);
+}
+
+void CarouselDashboard::layoutCarousels()
+{
+    const int nbCarousels = m_carousels.size();
+
+    if (nbCarousels == 0)
+        return;
+
+    const int columns = qMin(m_columns, nbCarousels);
+    const int rows = (nbCarousels + columns - 1)/columns;
+    const int cellWidth = width()/columns;
+    const int cellHeight = height()/rows;
+
+    for (int i = 0; i < nbCarousels; i++)
+    {
+        const QRect cell((i % columns)*cellWidth, (i/columns)*cellHeight, cellWidth, cellHeight);
+
+        m_carousels[i].rect = cell.adjusted(DASHBOARD_MARGIN, DASHBOARD_MARGIN + m_titleHeight,
+                                            -DASHBOARD_MARGIN, -DASHBOARD_MARGIN);
+        markDirty(i);
+    }
+
+    // Scenes of the previous sizes are not needed any more
+    m_renderer.clear();
+    update();
+}
+
+void CarouselDashboard::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    layoutCarousels();
+}
+
+void CarouselDashboard::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+
+    for (int i = 0; i < m_carousels.size(); i++)
+        markDirty(i);
+}
+
+void CarouselDashboard::paintEvent(QPaintEvent *event)
+{
+    PAINT_PROFILE("CarouselDashboard", event->rect());
+    TRACE_SCOPE("CarouselDashboard::paintEvent");
+
+    QPainter painter(this);
+    painter.fillRect(event->rect(), palette().window());
+    painter.setFont(QFont("Arial", 9, QFont::Bold));
+
+    for (const Carousel& carousel : qAsConst(m_carousels))
+    {
+        const QRect title(carousel.rect.left(), carousel.rect.top() - m_titleHeight, carousel.rect.width(), m_titleHeight);
+
+        if (!event->rect().intersects(carousel.rect | title))
+            continue;
+
+        painter.drawText(title, Qt::AlignLeft | Qt::AlignVCenter, carousel.title);
+
+        // Exposed again (scrolled, uncovered) while changes were pending
+        if (carousel.dirty && !m_scheduler->isRunning())
+            m_scheduler->wake();
+
+        if (!carousel.frame.isNull())
+            painter.drawImage(carousel.rect, carousel.frame);
+    }
+}
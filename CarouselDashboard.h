@@ -0,0 +1,77 @@
+#ifndef CAROUSELDASHBOARD_H
+#define CAROUSELDASHBOARD_H
+
+#include <QWidget>
+#include <QVector>
+#include <QThreadPool>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include "CarouselModel.h"
+#include "CarouselRenderer.h"
+#include "FrameScheduler.h"
+
+//---------------------------------------------------------------------------------------
+// class CarouselDashboard
+// Control room view of several sorters in one widget : every carousel is a rendered
+// image, not a widget tree. Model changes only mark a carousel dirty; one frame clock
+// hands the dirty and visible carousels to a shared worker pool, the longest waiting
+// first, with at most one render in flight per carousel. The clock stops when nothing
+// is left to render and the next change restarts it.
+//---------------------------------------------------------------------------------------
+
+static const int DASHBOARD_FRAME_INTERVAL = 50;     // ms, 20 frames per second at most
+
+class CarouselDashboard : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit CarouselDashboard(QWidget *parent = nullptr);
+    ~CarouselDashboard();
+
+    // The model is not owned, returns the index of the carousel
+    int  addCarousel(CarouselModel* model, const QString& title);
+    int  carouselCount() const { return m_carousels.size(); }
+
+    void setColumnCount(int columns);
+
+    // Renders done since the creation, for the load measurements
+    quint64 renderCount() const { return m_renderCount; }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
+private slots:
+    void on_frame();
+
+private:
+    struct Carousel
+    {
+        CarouselModel*          model;
+        QString                 title;
+        QRect                   rect;           // synoptic area, under the title
+        QImage                  frame;
+        bool                    dirty;
+        qint64                  dirtySince;     // ms on m_clock, orders the renders
+        QFutureWatcher<QImage>* watcher;
+    };
+
+    void markDirty(int index);
+    void layoutCarousels();
+    void startRender(int index);
+    void on_renderFinished(int index);
+    bool isShown(const Carousel& carousel) const;
+
+private:
+    QVector<Carousel>   m_carousels;
+    CarouselRenderer    m_renderer;
+    QThreadPool         m_pool;
+    FrameScheduler*     m_scheduler;
+    QElapsedTimer       m_clock;
+    int                 m_columns;
+    int                 m_titleHeight;
+    quint64             m_renderCount;
+};
+
+#endif // CAROUSELDASHBOARD_H
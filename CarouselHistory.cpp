@@ -0,0 +1,248 @@
+#include "CarouselHistory.h"
+#include <QDateTime>
+#include <algorithm>
+
+static const qint64 CHECKPOINT_INTERVAL = 60*1000;              // ms
+static const int    MAX_DELTAS          = 4096;                 // per checkpoint, bounds the seek cost
+static const qint64 DEFAULT_RETENTION   = 8*3600*1000;          // one shift
+static const qint64 DEFAULT_BUDGET      = 64*1024*1024;
+
+// Delta keys : bucket id << 1 for a state change, POSITION_KEY for a BCS position change
+static const quint32 POSITION_KEY = 1;
+
+static void writeVarint(QByteArray& out, quint32 value)
+{
+    while (value >= 0x80)
+    {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+static quint32 readVarint(const uchar*& data)
+{
+    quint32 value = 0;
+    int shift = 0;
+    uchar byte;
+
+    do
+    {
+        byte = *data++;
+        value |= quint32(byte & 0x7F) << shift;
+        shift += 7;
+    }
+    while (byte & 0x80);
+
+    return value;
+}
+
+static quint32 zigzag(qint32 value) { return (quint32(value) << 1) ^ quint32(value >> 31); }
+static qint32  unzigzag(quint32 value) { return qint32(value >> 1) ^ -qint32(value & 1); }
+
+
+CarouselHistory::CarouselHistory(CarouselModel* model, QObject *parent)
+    : QObject{parent},
+      m_model(model),
+      m_retention(DEFAULT_RETENTION),
+      m_memoryBudget(DEFAULT_BUDGET),
+      m_memoryUsage(0)
+{
+    addCheckpoint(now());
+
+    connect(m_model, &CarouselModel::bucketsChanged, this, &CarouselHistory::on_bucketsChanged);
+    connect(m_model, &CarouselModel::positionChanged, this, &CarouselHistory::on_positionChanged);
+}
+
+qint64 CarouselHistory::now() const
+{
+    return m_clock ? m_clock() : QDateTime::currentMSecsSinceEpoch();
+}
+
+qint64 CarouselHistory::firstTimestamp() const
+{
+    return m_checkpoints.empty() ? 0 : m_checkpoints.front().timestamp;
+}
+
+qint64 CarouselHistory::lastTimestamp() const
+{
+    return m_checkpoints.empty() ? 0 : m_checkpoints.back().lastTimestamp;
+}
+
+void CarouselHistory::addCheckpoint(qint64 now)
+{
+    const QVector<quint8>& states = m_model->states();
+
+    Checkpoint checkpoint;
+    checkpoint.timestamp     = now;
+    checkpoint.lastTimestamp = now;
+    checkpoint.position      = m_model->position();
+    checkpoint.deltaCount    = 0;
+    checkpoint.states        = QByteArray((states.size() + 1)/2, 0);
+
+    char* packed = checkpoint.states.data();
+
+    for (int i = 0; i < states.size(); i++)
+        packed[i/2] |= char((states[i] & 0x0F) << ((i & 1)*4));
+
+    m_memoryUsage += checkpoint.states.size();
+    m_checkpoints.push_back(checkpoint);
+
+    trim(now);
+}
+
+void CarouselHistory::appendDelta(qint64 now, quint32 key, qint32 value)
+{
+    Checkpoint& checkpoint = m_checkpoints.back();
+    const int previousSize = checkpoint.deltas.size();
+
+    writeVarint(checkpoint.deltas, quint32(now - checkpoint.lastTimestamp));
+    writeVarint(checkpoint.deltas, key);
+    writeVarint(checkpoint.deltas, zigzag(value));
+
+    checkpoint.lastTimestamp = now;
+    checkpoint.deltaCount++;
+    m_memoryUsage += checkpoint.deltas.size() - previousSize;
+}
+
+void CarouselHistory::trim(qint64 now)
+{
+    while (m_checkpoints.size() > 1 &&
+           (m_checkpoints.front().timestamp < now - m_retention || m_memoryUsage > m_memoryBudget))
+    {
+        m_memoryUsage -= m_checkpoints.front().states.size() + m_checkpoints.front().deltas.size();
+        m_checkpoints.pop_front();
+    }
+}
+
+void CarouselHistory::on_bucketsChanged(int first, int last)
+{
+    const qint64 now = this->now();
+    const Checkpoint& current = m_checkpoints.back();
+
+    // The model already holds the new states, a fresh checkpoint includes them
+    if (now - current.timestamp >= CHECKPOINT_INTERVAL || current.deltaCount + (last - first + 1) > MAX_DELTAS)
+    {
+        addCheckpoint(now);
+        return;
+    }
+
+    for (int id = first; id <= last; id++)
+        appendDelta(now, quint32(id) << 1, m_model->states()[id]);
+}
+
+void CarouselHistory::on_positionChanged(int bcsPosition)
+{
+    const qint64 now = this->now();
+    const Checkpoint& current = m_checkpoints.back();
+
+    if (now - current.timestamp >= CHECKPOINT_INTERVAL || current.deltaCount >= MAX_DELTAS)
+    {
+        addCheckpoint(now);
+        return;
+    }
+
+    appendDelta(now, POSITION_KEY, bcsPosition);
+}
+
+// Unpacks the 4 bits per bucket of a checkpoint
+static void unpack(const QByteArray& checkpoint, int nbBuckets, QVector<quint8>& states)
+{
+    const uchar* packed = reinterpret_cast<const uchar*>(checkpoint.constData());
+
+    states.resize(nbBuckets);
+    for (int i = 0; i < nbBuckets; i++)
+        states[i] = (packed[i/2] >> ((i & 1)*4)) & 0x0F;
+}
+
+// Applies the deltas up to the given time, data is left on the first later one
+static void replay(const uchar*& data, const uchar* end, qint64& time, qint64 until,
+                   QVector<quint8>& states, int& bcsPosition)
+{
+    const int nbBuckets = states.size();
+
+    while (data < end)
+    {
+        const uchar* next = data;
+        const qint64 deltaTime = time + readVarint(next);
+
+        if (deltaTime > until)
+            break;
+
+        const quint32 key   = readVarint(next);
+        const qint32  value = unzigzag(readVarint(next));
+
+        data = next;
+        time = deltaTime;
+
+        if (key == POSITION_KEY)
+            bcsPosition = value;
+        else if (int(key >> 1) < nbBuckets)
+            states[key >> 1] = quint8(value);
+    }
+}
+
+bool CarouselHistory::stateAt(qint64 timestamp, QVector<quint8>& states, int& bcsPosition) const
+{
+    if (m_checkpoints.empty() || timestamp < m_checkpoints.front().timestamp)
+        return false;
+
+    const Checkpoint& checkpoint = checkpointAt(timestamp);
+    unpack(checkpoint.states, m_model->bucketCount(), states);
+    bcsPosition = checkpoint.position;
+
+    const uchar* data = reinterpret_cast<const uchar*>(checkpoint.deltas.constData());
+    qint64 time = checkpoint.timestamp;
+    replay(data, data + checkpoint.deltas.size(), time, timestamp, states, bcsPosition);
+
+    return true;
+}
+
+int CarouselHistory::statesAt(const QVector<qint64>& timestamps, const StateVisitor& visitor) const
+{
+    if (m_checkpoints.empty())
+        return 0;
+
+    QVector<quint8> states;
+    int bcsPosition = 0;
+
+    const Checkpoint* current = nullptr;
+    const uchar* data = nullptr;
+    const uchar* end = nullptr;
+    qint64 time = 0;
+    int visited = 0;
+
+    for (qint64 timestamp : timestamps)
+    {
+        // Not recorded, or before the deltas already replayed : the replay only goes forward
+        if (timestamp < m_checkpoints.front().timestamp || (current != nullptr && timestamp < time))
+            continue;
+
+        const Checkpoint& checkpoint = checkpointAt(timestamp);
+
+        if (&checkpoint != current)
+        {
+            current = &checkpoint;
+            unpack(checkpoint.states, m_model->bucketCount(), states);
+            bcsPosition = checkpoint.position;
+
+            data = reinterpret_cast<const uchar*>(checkpoint.deltas.constData());
+            end  = data + checkpoint.deltas.size();
+            time = checkpoint.timestamp;
+        }
+
+        replay(data, end, time, timestamp, states, bcsPosition);
+        visitor(timestamp, states, bcsPosition);
+        visited++;
+    }
+
+    return visited;
+}
+
+// Last checkpoint taken at or before the given time, which is not earlier than the first one
+const CarouselHistory::Checkpoint& CarouselHistory::checkpointAt(qint64 timestamp) const
+{
+    auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), timestamp,
+                               [](qint64 time, const Checkpoint& checkpoint) { return time < checkpoint.timestamp; });
+    return *(--it);
+}
@@ -0,0 +1,77 @@
+#ifndef CAROUSELHISTORY_H
+#define CAROUSELHISTORY_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QVector>
+#include <deque>
+#include <functional>
+#include "CarouselModel.h"
+
+//---------------------------------------------------------------------------------------
+// class CarouselHistory
+// Time-travel store of a carousel model : periodic checkpoints of the packed bucket
+// array (4 bits per bucket) followed by varint-encoded deltas.
+// Rebuilding any instant costs one checkpoint copy plus at most MAX_DELTAS deltas.
+//---------------------------------------------------------------------------------------
+
+class CarouselHistory : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CarouselHistory(CarouselModel* model, QObject *parent = nullptr);
+
+    CarouselModel* model() const { return m_model; }
+
+    qint64 firstTimestamp() const;
+    qint64 lastTimestamp() const;
+    qint64 memoryUsage() const { return m_memoryUsage; }
+
+    // Rebuilds the bucket states and BCS position at the given time (ms since epoch)
+    bool   stateAt(qint64 timestamp, QVector<quint8>& states, int& bcsPosition) const;
+
+    // Same for a series of ascending timestamps, in one forward pass : each checkpoint is
+    // unpacked and its deltas replayed once, however many instants fall between them.
+    // Returns the number of instants visited, the earlier ones than the history are skipped.
+    typedef std::function<void(qint64 timestamp, const QVector<quint8>& states, int bcsPosition)> StateVisitor;
+    int    statesAt(const QVector<qint64>& timestamps, const StateVisitor& visitor) const;
+
+    // Time source of the records, the wall clock by default (simulated shifts in the benchmarks)
+    typedef std::function<qint64()> Clock;
+    void   setClock(const Clock& clock) { m_clock = clock; }
+
+    void   setRetention(qint64 retention) { m_retention = retention; }
+    void   setMemoryBudget(qint64 bytes) { m_memoryBudget = bytes; }
+
+private slots:
+    void on_bucketsChanged(int first, int last);
+    void on_positionChanged(int bcsPosition);
+
+private:
+    struct Checkpoint
+    {
+        qint64      timestamp;
+        qint64      lastTimestamp;      // of the last delta
+        int         position;
+        QByteArray  states;
+        QByteArray  deltas;
+        int         deltaCount;
+    };
+
+    qint64 now() const;
+    const Checkpoint& checkpointAt(qint64 timestamp) const;
+    void addCheckpoint(qint64 now);
+    void appendDelta(qint64 now, quint32 key, qint32 value);
+    void trim(qint64 now);
+
+private:
+    CarouselModel*          m_model;
+    std::deque<Checkpoint>  m_checkpoints;
+
+    qint64                  m_retention;
+    qint64                  m_memoryBudget;
+    qint64                  m_memoryUsage;
+    Clock                   m_clock;
+};
+
+#endif // CAROUSELHISTORY_H
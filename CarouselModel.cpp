@@ -0,0 +1,338 @@
+#include "CarouselModel.h"
+#include "TransitionRecorder.h"
+#include "TraceRecorder.h"
+#include <algorithm>
+
+static const int STATISTICS_INTERVAL = 16;
+
+CarouselModel::CarouselModel(int nbBuckets, QObject *parent)
+    : QObject{parent},
+      m_states(nbBuckets, static_cast<quint8>(BucketState::EMPTY)),
+      m_previousStates(nbBuckets, static_cast<quint8>(BucketState::EMPTY)),
+      m_transitionCount(0),
+      m_statisticsTimer(new QTimer(this)),
+      m_position(0),
+      m_headOffset(0),
+      m_recorder(nullptr),
+      m_parcelOfBucket(nbBuckets)
+{
+    for (int i = 0; i < BUCKET_STATE_COUNT; i++)
+        m_counts[i] = 0;
+    m_counts[static_cast<int>(BucketState::EMPTY)] = nbBuckets;
+
+    for (int i = 0; i < RATE_WINDOW; i++)
+        m_rates[i] = {-1, 0, 0};
+
+    m_clock.start();
+
+    m_statisticsTimer->setSingleShot(true);
+    m_statisticsTimer->setInterval(STATISTICS_INTERVAL);
+    connect(m_statisticsTimer, &QTimer::timeout, this, &CarouselModel::on_statisticsTimer);
+}
+
+void CarouselModel::setState(int id, BucketState state)
+{
+    if (id < 0 || id >= m_states.size())
+        return;
+
+    const quint8 packed = static_cast<quint8>(state);
+
+    // Only notify the views when something really changed
+    if (m_states[id] == packed)
+        return;
+
+    storeState(id, packed);
+
+    emit bucketsChanged(id, id);
+}
+
+// Diffs a packed array against the model (gateway, telegrams) : one notification for the changed range
+void CarouselModel::applyStates(int first, const quint8* states, int count, int bcsPosition)
+{
+    TRACE_SCOPE("CarouselModel::applyStates");
+
+    if (first < 0)
+        return;
+
+    const int end = qMin(first + count, m_states.size());
+
+    int firstChanged = -1;
+    int lastChanged = -1;
+
+    for (int id = first; id < end; id++)
+    {
+        const quint8 packed = states[id - first];
+
+        if (packed == m_states[id] || packed >= BUCKET_STATE_COUNT)
+            continue;
+
+        storeState(id, packed);
+
+        if (firstChanged < 0)
+            firstChanged = id;
+        lastChanged = id;
+    }
+
+    setPosition(bcsPosition);
+
+    if (firstChanged >= 0)
+        emit bucketsChanged(firstChanged, lastChanged);
+}
+
+void CarouselModel::storeState(int id, quint8 packed, bool indexed)
+{
+    const quint8 disabled = static_cast<quint8>(BucketState::DISABLED);
+
+    // Disabling keeps the state to come back to once the bucket is enabled again
+    if (packed == disabled)
+    {
+        m_previousStates[id] = m_states[id];
+
+        if (!indexed)
+            m_disabled.insert(id, id);
+    }
+    else if (m_states[id] == disabled && !indexed)
+        m_disabled.remove(id, id);
+
+    if (m_recorder)
+        m_recorder->record(m_position, id, m_states[id], packed);
+
+    countTransition(m_states[id], packed);
+    m_states[id] = packed;
+
+    // An emptied bucket no longer carries its parcel
+    if (packed == static_cast<quint8>(BucketState::EMPTY) && !m_parcelOfBucket[id].isEmpty())
+    {
+        m_parcels.remove(m_parcelOfBucket[id]);
+        m_parcelOfBucket[id].clear();
+    }
+}
+
+// Loads a complete state at once (history, snapshots), views get a single notification.
+// What was known of the replaced state goes with it : the state a disabled bucket comes back
+// to is EMPTY, and no parcel is assigned any more
+void CarouselModel::setStates(const QVector<quint8>& states, int bcsPosition)
+{
+    if (states.size() != m_states.size())
+        return;
+
+    m_states = states;
+
+    m_previousStates = states;
+    std::replace(m_previousStates.begin(), m_previousStates.end(),
+                 static_cast<quint8>(BucketState::DISABLED), static_cast<quint8>(BucketState::EMPTY));
+
+    m_parcels.clear();
+    m_parcelOfBucket.fill(QString());
+
+    for (int i = 0; i < BUCKET_STATE_COUNT; i++)
+        m_counts[i] = 0;
+
+    for (int i = 0; i < m_states.size(); i++)
+        m_counts[m_states[i]]++;
+
+    // Disabled runs are indexed again in one scan
+    m_disabled.clear();
+
+    for (int i = 0; i < m_states.size(); i++)
+    {
+        if (m_states[i] != static_cast<quint8>(BucketState::DISABLED))
+            continue;
+
+        int last = i;
+        while (last + 1 < m_states.size() && m_states[last + 1] == static_cast<quint8>(BucketState::DISABLED))
+            last++;
+
+        m_disabled.insert(i, last);
+        i = last;
+    }
+
+    if (!m_statisticsTimer->isActive())
+        m_statisticsTimer->start();
+
+    // The position is applied first so the views rebuild their slots only once
+    const bool blocked = blockSignals(true);
+    setPosition(bcsPosition);
+    blockSignals(blocked);
+
+    emit bucketsChanged(0, m_states.size() - 1);
+}
+
+void CarouselModel::restorePreviousState(int id)
+{
+    if (id < 0 || id >= m_states.size() || state(id) != BucketState::DISABLED)
+        return;
+
+    setState(id, static_cast<BucketState>(m_previousStates[id]));
+}
+
+void CarouselModel::disableRange(int first, int last)
+{
+    first = qMax(first, 0);
+    last  = qMin(last, m_states.size() - 1);
+
+    if (first > last)
+        return;
+
+    // Only the gaps between the already disabled intervals change
+    const quint8 disabled = static_cast<quint8>(BucketState::DISABLED);
+    int next = first;
+    int changedFirst = -1;
+    int changedLast = -1;
+
+    auto disableGap = [&](int gapFirst, int gapLast)
+    {
+        if (gapFirst > gapLast)
+            return;
+
+        for (int id = gapFirst; id <= gapLast; id++)
+            storeState(id, disabled, true);
+
+        if (changedFirst < 0)
+            changedFirst = gapFirst;
+        changedLast = gapLast;
+    };
+
+    for (const IntervalSet::Interval& interval : m_disabled.intervals(first, last))
+    {
+        disableGap(next, interval.first - 1);
+        next = interval.second + 1;
+    }
+
+    disableGap(next, last);
+
+    if (changedFirst < 0)
+        return;
+
+    // The index is updated once for the whole range, not bucket by bucket
+    m_disabled.insert(first, last);
+    emit bucketsChanged(changedFirst, changedLast);
+}
+
+void CarouselModel::enableRange(int first, int last)
+{
+    const QVector<IntervalSet::Interval> intervals = m_disabled.intervals(qMax(first, 0), qMin(last, m_states.size() - 1));
+
+    if (intervals.isEmpty())
+        return;
+
+    // The index is updated once for the whole range, not bucket by bucket
+    m_disabled.remove(first, last);
+
+    for (const IntervalSet::Interval& interval : intervals)
+    {
+        for (int id = interval.first; id <= interval.second; id++)
+            storeState(id, m_previousStates[id], true);
+    }
+
+    emit bucketsChanged(intervals.first().first, intervals.last().second);
+}
+
+// O(1) bookkeeping of the per-state counters and of the sliding window rates
+void CarouselModel::countTransition(quint8 oldState, quint8 newState)
+{
+    m_counts[oldState]--;
+    m_counts[newState]++;
+    m_transitionCount++;
+
+    if (newState == static_cast<quint8>(BucketState::SORTED) ||
+        newState == static_cast<quint8>(BucketState::REJECTED))
+    {
+        const qint64 second = m_clock.elapsed()/1000;
+        RateSlot& slot = m_rates[second % RATE_WINDOW];
+
+        if (slot.second != second)
+            slot = {second, 0, 0};
+
+        if (newState == static_cast<quint8>(BucketState::SORTED))
+            slot.sorted++;
+        else
+            slot.rejected++;
+    }
+
+    if (!m_statisticsTimer->isActive())
+        m_statisticsTimer->start();
+}
+
+CarouselStatistics CarouselModel::statistics() const
+{
+    CarouselStatistics statistics;
+
+    for (int i = 0; i < BUCKET_STATE_COUNT; i++)
+        statistics.counts[i] = m_counts[i];
+
+    const int enabled  = m_states.size() - count(BucketState::DISABLED);
+    const int occupied = count(BucketState::INJECTED) + count(BucketState::SORTED) + count(BucketState::REJECTED);
+
+    statistics.occupancyRate = enabled > 0 ? double(occupied)/enabled : 0.0;
+
+    const qint64 second = m_clock.elapsed()/1000;
+    int sorted = 0;
+    int rejected = 0;
+
+    for (int i = 0; i < RATE_WINDOW; i++)
+    {
+        if (m_rates[i].second > second - RATE_WINDOW)
+        {
+            sorted += m_rates[i].sorted;
+            rejected += m_rates[i].rejected;
+        }
+    }
+
+    statistics.sortedPerMinute = sorted;
+    statistics.rejectRatio = (sorted + rejected) > 0 ? double(rejected)/(sorted + rejected) : 0.0;
+
+    return statistics;
+}
+
+void CarouselModel::on_statisticsTimer()
+{
+    emit statisticsChanged(statistics());
+}
+
+void CarouselModel::setPosition(int bcsPosition)
+{
+    TRACE_SCOPE("CarouselModel::setPosition");
+
+    if (bcsPosition == m_position || m_states.isEmpty())
+        return;
+
+    m_position = bcsPosition;
+
+    // The head offset is the only thing the rotation changes
+    m_headOffset = headOffsetOf(m_position, m_states.size());
+
+    emit positionChanged(m_position);
+}
+
+// Recorded positions (history, exports) map to slots the same way as the live one
+int CarouselModel::headOffsetOf(int bcsPosition, int nbBuckets)
+{
+    const int headOffset = bcsPosition % nbBuckets;
+    return headOffset < 0 ? headOffset + nbBuckets : headOffset;
+}
+
+void CarouselModel::assignParcel(const QString& parcelId, int id)
+{
+    if (id < 0 || id >= m_states.size())
+        return;
+
+    releaseParcel(parcelId);
+
+    if (!m_parcelOfBucket[id].isEmpty())
+        m_parcels.remove(m_parcelOfBucket[id]);
+
+    m_parcels.insert(parcelId, id);
+    m_parcelOfBucket[id] = parcelId;
+}
+
+void CarouselModel::releaseParcel(const QString& parcelId)
+{
+    const int id = bucketOfParcel(parcelId);
+
+    if (id < 0)
+        return;
+
+    m_parcels.remove(parcelId);
+    m_parcelOfBucket[id].clear();
+}
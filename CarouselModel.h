@@ -0,0 +1,117 @@
+#ifndef CAROUSELMODEL_H
+#define CAROUSELMODEL_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <Conveyor/Conveyor_T2K.h>
+#include "IntervalSet.h"
+#include "StatePalette.h"
+
+class TransitionRecorder;
+
+
+struct CarouselStatistics
+{
+    int    counts[BUCKET_STATE_COUNT];
+    double occupancyRate;       // INJECTED, SORTED and REJECTED buckets over the enabled ones
+    int    sortedPerMinute;
+    double rejectRatio;         // REJECTED over SORTED + REJECTED transitions of the last minute
+};
+
+// Packed bucket states shared by every view of one carousel.
+// Views never own the state : they read it back from here when bucketsChanged is emitted.
+// States are indexed by bucket id, the rotation only moves the head offset :
+// the visual slot of a bucket is derived from it, so no data moves when the carousel turns.
+class CarouselModel : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CarouselModel(int nbBuckets, QObject *parent = nullptr);
+
+    int         bucketCount() const { return m_states.size(); }
+    BucketState state(int id) const { return static_cast<BucketState>(m_states[id]); }
+
+    void        setState(int id, BucketState state);
+    void        restorePreviousState(int id);
+
+    // Maintenance lockouts : whole ranges are disabled and enabled again with one notification,
+    // enabling restores the state each bucket had before
+    void        disableRange(int first, int last);
+    void        enableRange(int first, int last);
+    bool        isDisabled(int id) const { return m_disabled.contains(id); }
+    const IntervalSet& disabledRanges() const { return m_disabled; }
+
+    // Whole packed array, one byte per bucket id
+    const QVector<quint8>& states() const { return m_states; }
+    void        setStates(const QVector<quint8>& states, int bcsPosition);
+    void        applyStates(int first, const quint8* states, int count, int bcsPosition);
+
+    int         count(BucketState state) const { return m_counts[static_cast<int>(state)]; }
+    quint64     transitionCount() const { return m_transitionCount; }
+    CarouselStatistics statistics() const;
+
+    // Every transition is appended to the recorder log, nullptr to stop recording
+    void        setRecorder(TransitionRecorder* recorder) { m_recorder = recorder; }
+
+    int         position() const { return m_position; }
+    int         headOffset() const { return m_headOffset; }
+    static int  headOffsetOf(int bcsPosition, int nbBuckets);
+    void        setPosition(int bcsPosition);
+
+    // Slot 0 is the first bucket of the synoptic
+    int         idAtSlot(int slot) const { return (slot + m_headOffset) % m_states.size(); }
+    int         slotOf(int id) const { return (id - m_headOffset + m_states.size()) % m_states.size(); }
+
+    void        assignParcel(const QString& parcelId, int id);
+    void        releaseParcel(const QString& parcelId);
+    int         bucketOfParcel(const QString& parcelId) const { return m_parcels.value(parcelId, -1); }
+
+signals:
+    // Inclusive range of bucket ids whose state changed
+    void bucketsChanged(int first, int last);
+    void positionChanged(int bcsPosition);
+
+    // Emitted at most once per frame, whatever the number of transitions
+    void statisticsChanged(const CarouselStatistics& statistics);
+
+private slots:
+    void on_statisticsTimer();
+
+private:
+    // indexed : the caller updates m_disabled itself, once for a whole range
+    void storeState(int id, quint8 packed, bool indexed = false);
+    void countTransition(quint8 oldState, quint8 newState);
+
+private:
+    // One minute sliding window of transitions, one slot per second
+    struct RateSlot
+    {
+        qint64 second;
+        int    sorted;
+        int    rejected;
+    };
+    static const int RATE_WINDOW = 60;
+
+    QVector<quint8>     m_states;
+    QVector<quint8>     m_previousStates;
+    IntervalSet         m_disabled;         // always matches the DISABLED entries of m_states
+    int                 m_counts[BUCKET_STATE_COUNT];
+    quint64             m_transitionCount;
+    RateSlot            m_rates[RATE_WINDOW];
+    QElapsedTimer       m_clock;
+    QTimer*             m_statisticsTimer;
+    int                 m_position;
+    int                 m_headOffset;
+
+    TransitionRecorder* m_recorder;
+
+    QHash<QString, int> m_parcels;
+    QVector<QString>    m_parcelOfBucket;
+};
+
+Q_DECLARE_METATYPE(CarouselStatistics)
+
+#endif // CAROUSELMODEL_H
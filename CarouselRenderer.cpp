@@ -0,0 +1,169 @@
+#include "CarouselRenderer.h"
+#include "LabelCache.h"
+#include "TraceRecorder.h"
+#include <QPainter>
+
+static const int LABEL_MIN_WIDTH = 24;      // cells narrower than this are painted without label
+
+// Same path as SemicircleWidget : two nested half circles joining the ends of the lines
+QPainterPath CarouselRenderer::curvesPath(const CarouselScene& scene, bool flip)
+{
+    const QRect rect = flip ? QRect(0, 0, scene.curvesWidth, scene.size.height())
+                            : QRect(scene.size.width() - scene.curvesWidth, 0, scene.curvesWidth, scene.size.height());
+    const int circlesDist = scene.lineHeight - 2;
+    const int R = rect.width() - 1;
+    const int r = R - circlesDist;
+    const int h = rect.height();
+
+    QPainterPath path;
+
+    if (flip)
+    {
+        path.moveTo(rect.width(), 1);
+        path.quadTo(1, 1, 1, h/2);
+        path.quadTo(1, h - 1, rect.width(), h - 1);
+        path.moveTo(rect.width(), 1 + circlesDist);
+        path.quadTo(1 + circlesDist, 1 + circlesDist, 1 + circlesDist, h/2);
+        path.quadTo(1 + circlesDist, h - 1 - circlesDist, rect.width(), h - 1 - circlesDist);
+    }
+    else
+    {
+        path.moveTo(0, 1);
+        path.quadTo(R, 1, R, h/2);
+        path.quadTo(R, h - 1, 0, h - 1);
+        path.moveTo(0, 1 + circlesDist);
+        path.quadTo(r, 1 + circlesDist, r, h/2);
+        path.quadTo(r, h - 1 - circlesDist, 0, h - 1 - circlesDist);
+    }
+
+    return path.translated(rect.topLeft());
+}
+
+QRect CarouselScene::tileRect(BucketState state, int width) const
+{
+    return QRect(static_cast<int>(state)*(cellWidth + 1), 0, width, lineHeight);
+}
+
+CarouselScene CarouselRenderer::scene(const QSize& size, int nbBuckets)
+{
+    const quint64 key = (quint64(size.width()) << 48) | (quint64(size.height() & 0xFFFF) << 32) | quint32(nbBuckets);
+
+    auto it = m_scenes.constFind(key);
+
+    if (it != m_scenes.constEnd())
+        return it.value();
+
+    CarouselScene scene = buildScene(size, nbBuckets);
+    m_scenes.insert(key, scene);
+    return scene;
+}
+
+// Geometry of BasicCarousel::computeGeometry, applied to an image
+CarouselScene CarouselRenderer::buildScene(const QSize& size, int nbBuckets)
+{
+    TRACE_SCOPE("CarouselRenderer::buildScene");
+
+    CarouselScene scene;
+
+    scene.size           = size;
+    scene.nbBuckets      = nbBuckets;
+    scene.nbFront        = nbBuckets/2;
+    scene.curvesWidth    = 0.11*size.width();
+    scene.lineHeight     = 0.3*size.height();
+    scene.availableWidth = size.width() - 2*scene.curvesWidth;
+    scene.cellWidth      = nbBuckets > 0 ? scene.availableWidth/((nbBuckets + 1)/2) : 0;
+
+    if (scene.cellWidth <= 0 || scene.lineHeight <= 0)
+        return scene;
+
+    // One tile per state, the left, top and bottom borders included
+    scene.atlas = QImage((scene.cellWidth + 1)*BUCKET_STATE_COUNT, scene.lineHeight, QImage::Format_ARGB32_Premultiplied);
+    scene.atlas.fill(QColor(SYNOPTIC_BACKGROUND));
+
+    QPainter atlasPainter(&scene.atlas);
+    const QBrush hatch(Qt::black, Qt::BDiagPattern);
+
+    for (int i = 0; i < BUCKET_STATE_COUNT; i++)
+    {
+        const BucketState state = static_cast<BucketState>(i);
+        const QRect tile = scene.tileRect(state, scene.cellWidth + 1);
+
+        atlasPainter.fillRect(tile, QColor::fromRgba(StatePalette::bucket(state)));
+
+        if (state == BucketState::UNKNOWN || state == BucketState::DISABLED)
+            atlasPainter.fillRect(tile, hatch);
+
+        atlasPainter.setPen(Qt::black);
+        atlasPainter.drawLine(tile.topLeft(), tile.bottomLeft());
+        atlasPainter.drawLine(tile.topLeft(), tile.topRight());
+        atlasPainter.drawLine(tile.bottomLeft(), tile.bottomRight());
+    }
+
+    atlasPainter.end();
+
+    scene.background = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    scene.background.fill(QColor(SYNOPTIC_BACKGROUND));
+
+    QPainter backgroundPainter(&scene.background);
+    backgroundPainter.setRenderHint(QPainter::Antialiasing);
+    backgroundPainter.setPen(QPen(Qt::black, 1, Qt::SolidLine, Qt::FlatCap, Qt::MiterJoin));
+    backgroundPainter.setBrush(QColor(SYNOPTIC_CURVES_COLOR));
+    backgroundPainter.drawPath(curvesPath(scene, true));
+    backgroundPainter.drawPath(curvesPath(scene, false));
+    backgroundPainter.end();
+
+    if (scene.cellWidth >= LABEL_MIN_WIDTH)
+    {
+        scene.labels.reserve(nbBuckets);
+
+        for (int id = 0; id < nbBuckets; id++)
+            scene.labels.append(LabelCache::number(id));
+    }
+
+    return scene;
+}
+
+QImage CarouselRenderer::render(const CarouselScene& scene, const QVector<quint8>& states, int headOffset)
+{
+    QImage image(scene.size, QImage::Format_ARGB32_Premultiplied);
+    render(scene, states, headOffset, image);
+    return image;
+}
+
+void CarouselRenderer::render(const CarouselScene& scene, const QVector<quint8>& states, int headOffset, QImage& image)
+{
+    TRACE_SCOPE("CarouselRenderer::render");
+
+    if (!scene.isValid() || states.size() != scene.nbBuckets || image.size() != scene.size)
+        return;
+
+    QPainter painter(&image);
+
+    // Opaque tiles are plain copies, labels need blending
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.drawImage(0, 0, scene.background);
+
+    if (!scene.labels.isEmpty())
+    {
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        painter.setFont(QFont("Arial", scene.fontSize, QFont::Normal));
+    }
+
+    painter.setPen(Qt::black);
+
+    scene.visitCells(headOffset, [&](const QRect& cell, int id)
+    {
+        const quint8 packed = states[id];
+        const BucketState state = packed < BUCKET_STATE_COUNT ? static_cast<BucketState>(packed) : BucketState::UNKNOWN;
+
+        painter.drawImage(cell.topLeft(), scene.atlas, scene.tileRect(state, cell.width()));
+
+        if (!scene.labels.isEmpty())
+            painter.drawText(cell, Qt::AlignCenter, scene.labels[id]);
+    },
+    [&](const QRect& line)
+    {
+        // Closing border of the line
+        painter.drawLine(line.topRight(), line.bottomRight());
+    });
+}
@@ -0,0 +1,99 @@
+#ifndef CAROUSELRENDERER_H
+#define CAROUSELRENDERER_H
+
+#include <QImage>
+#include <QVector>
+#include <QString>
+#include <QHash>
+#include <QPainterPath>
+#include "CarouselModel.h"
+
+//---------------------------------------------------------------------------------------
+// class CarouselRenderer
+// Paints the BasicCarousel synoptic of a packed bucket array into an image, without any
+// widget. Everything depending only on the geometry (curves, one tile per bucket state,
+// labels) is prepared once per size into an immutable CarouselScene on the GUI thread;
+// render() only blits tiles and may run on any thread.
+//---------------------------------------------------------------------------------------
+
+static const QRgb SYNOPTIC_BACKGROUND   = qRgb(240, 240, 240);
+static const QRgb SYNOPTIC_CURVES_COLOR = qRgb(170, 170, 170);
+
+struct CarouselScene
+{
+    QSize               size;
+    int                 nbBuckets       = 0;
+    int                 nbFront         = 0;    // the back line gets the odd bucket
+    int                 curvesWidth     = 0;
+    int                 lineHeight      = 0;
+    int                 cellWidth       = 0;    // rounded down, the first cells of a line get one more pixel
+    int                 availableWidth  = 0;
+    int                 fontSize        = 7;
+
+    QImage              background;             // curves and empty lines
+    QImage              atlas;                  // BUCKET_STATE_COUNT tiles of (cellWidth + 1) x lineHeight
+    QVector<QString>    labels;                 // by bucket id, empty when the cells are too narrow
+
+    bool   isValid() const { return !atlas.isNull(); }
+    QRect  tileRect(BucketState state, int width) const;
+
+    // Calls visit(QRect cell, int id) for every slot, back line on top drawn right to left
+    // from the last slot, front line at the bottom; then lineEnd(QRect line) for each line
+    template <typename Visit, typename LineEnd>
+    void   visitCells(int headOffset, Visit visit, LineEnd lineEnd) const;
+};
+
+template <typename Visit, typename LineEnd>
+void CarouselScene::visitCells(int headOffset, Visit visit, LineEnd lineEnd) const
+{
+    const int nbLines[2] = { nbBuckets - nbFront, nbFront };
+    const int lineTop[2] = { 0, size.height() - lineHeight };
+
+    for (int line = 0; line < 2; line++)
+    {
+        const int nbCells = nbLines[line];
+        int nb_oversizeCells = availableWidth - cellWidth*nbCells;
+        int x = curvesWidth;
+
+        for (int i = 0; i < nbCells; i++)
+        {
+            int w = cellWidth;
+
+            if (nb_oversizeCells > 0)
+            {
+                w++;
+                nb_oversizeCells--;
+            }
+
+            const int slot = line == 0 ? nbBuckets - 1 - i : i;
+            visit(QRect(x, lineTop[line], w, lineHeight), (slot + headOffset) % nbBuckets);
+
+            x += w;
+        }
+
+        lineEnd(QRect(curvesWidth, lineTop[line], x - curvesWidth, lineHeight));
+    }
+}
+
+class CarouselRenderer
+{
+public:
+    // GUI thread, cached per size and bucket count
+    CarouselScene scene(const QSize& size, int nbBuckets);
+    void          clear() { m_scenes.clear(); }
+
+    // Any thread : the scene and the states are only read
+    static void   render(const CarouselScene& scene, const QVector<quint8>& states, int headOffset, QImage& image);
+    static QImage render(const CarouselScene& scene, const QVector<quint8>& states, int headOffset);
+
+    // Outline of the curves at the left (flip) or right end of the lines, in scene coordinates
+    static QPainterPath curvesPath(const CarouselScene& scene, bool flip);
+
+private:
+    static CarouselScene buildScene(const QSize& size, int nbBuckets);
+
+private:
+    QHash<quint64, CarouselScene> m_scenes;
+};
+
+#endif // CAROUSELRENDERER_H
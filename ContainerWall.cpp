@@ -0,0 +1,82 @@
+#include "ContainerWall.h"
+#include "PaintProfiler.h"
+#include <QPainter>
+
+static const double RESERVE_HEIGHT_RATIO = 0.35;    // part of a line taken by the reserve tray
+
+ContainerWall::ContainerWall(ConveyorModel* model, QWidget *parent)
+    : TrayWall(model->outputsPerSide(), parent),
+      m_model(model),
+      m_borderThickness(1)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    // Same look as a selected TrayContainer
+    setSelectionStyle(QColor(18, 138, 230, 51), QColor("#128AE6"), 3);
+
+    updateAlarms(0, cellCount() - 1);
+
+    connect(m_model, &ConveyorModel::containersChanged, this, [this](int first, int last, int fields)
+    {
+        if (fields & FIELD_CONTAINER_STATE)
+            updateAlarms(first, last);
+
+        if (fields & (FIELD_CONTAINER_STATE | FIELD_CONTAINER_RESERVE))
+            updateRange(first, last);
+    });
+}
+
+// Containers in a fault state blink, see StatePalette::isAlarm
+void ContainerWall::updateAlarms(int first, int last)
+{
+    setAlarmedRange(first, last, [this](int index) { return m_model->isContainerAlarmed(index); });
+}
+
+void ContainerWall::paintEvent(QPaintEvent *event)
+{
+    PAINT_PROFILE("ContainerWall", event->rect());
+
+    QPainter painter(this);
+    painter.fillRect(event->rect(), palette().window());
+    painter.setPen(QPen(QColor("#000"), m_borderThickness, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin));
+
+    // Only the cells intersecting the invalidated rectangle are visited
+    int firstLine, lastLine, firstCell, lastCell;
+
+    if (!cellsIn(event->rect(), firstLine, lastLine, firstCell, lastCell))
+        return;
+
+    const int reserveHeight = int(height()/TRAY_WALL_LINES*RESERVE_HEIGHT_RATIO);
+    const QBrush hatch(QColor("#000"), Qt::BDiagPattern);
+    const QColor reserveColor(255, 255, 255);
+
+    for (int line = firstLine; line <= lastLine; line++)
+    {
+        for (int container = line*cellsPerLine() + firstCell; container <= line*cellsPerLine() + lastCell; container++)
+        {
+            const QRect cell = cellRect(container);
+
+            // Container on top, its reserve below in the same cell
+            const QRect containerRect = cell.adjusted(0, 0, -m_borderThickness, -reserveHeight - m_borderThickness);
+            const ContainerTrayState state = m_model->containerState(container);
+
+            painter.fillRect(containerRect, TrayContainer::stateColor(state));
+
+            if (state == ContainerTrayState::EJECTED)
+                painter.fillRect(containerRect, hatch);
+
+            painter.drawRect(containerRect);
+
+            if (m_model->isReservePresent(container))
+            {
+                const QRect reserveRect(cell.left(), containerRect.bottom() + 1,
+                                        cell.width() - m_borderThickness, reserveHeight - m_borderThickness);
+                painter.fillRect(reserveRect, reserveColor);
+                painter.drawRect(reserveRect);
+            }
+        }
+    }
+
+    paintAlarms(painter, event->rect());
+    paintSelection(painter, event->rect());
+}
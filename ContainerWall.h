@@ -0,0 +1,36 @@
+#ifndef CONTAINERWALL_H
+#define CONTAINERWALL_H
+
+#include <QPaintEvent>
+#include "TrayWall.h"
+
+//---------------------------------------------------------------------------------------
+// class ContainerWall
+// Containers of all outputs and their reserve trays, read from the ConveyorModel columns
+// and painted in one pass with each reserve drawn under its container. Product and tray
+// id changes are not drawn and repaint nothing.
+//---------------------------------------------------------------------------------------
+
+class ContainerWall : public TrayWall
+{
+    Q_OBJECT
+public:
+    // The model is not owned, several views may share it
+    explicit ContainerWall(ConveyorModel* model, QWidget *parent = nullptr);
+
+    ConveyorModel* model() const { return m_model; }
+    int containersPerSide() const { return cellsPerLine(); }
+    int containerCount() const { return cellCount(); }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void updateAlarms(int first, int last);
+
+private:
+    ConveyorModel*  m_model;
+    int             m_borderThickness;
+};
+
+#endif // CONTAINERWALL_H
@@ -9,8 +9,33 @@
 |
 +=======================================================================================*/
 #include "Conveyor_T2K.h"
+#include <PaintProfiler.h>
+#include <TraceRecorder.h>
+#include <AlarmAnimator.h>
+#include <StatePalette.h>
+#include <LabelCache.h>
 #include <QDebug>
 
+// Style sheets shared by all the trays : a tray only takes a reference on one of them. The
+// hatch is painted, switching to a hatched style sheet would re-polish the widget
+static const QString TRAY_STYLE               = "border:1px solid black; ";
+static const QString TRAY_STYLE_NO_RIGHT      = TRAY_STYLE + "border-right:0;";
+
+static const QColor  PRESSED_COLOR = QColor(0x5E, 0xA9, 0xF3);
+
+// The left neighbour draws the shared border, except for the last tray of a line
+static const QString& trayStyle(bool isLast)
+{
+    return isLast ? TRAY_STYLE : TRAY_STYLE_NO_RIGHT;
+}
+
+// Same diagonal hatch as the synoptic exports, shared by every hatched tray
+static const QBrush& hatchBrush()
+{
+    static const QBrush brush(Qt::black, Qt::BDiagPattern);
+    return brush;
+}
+
 //---------------------------------------------------------------------------------------
 // class TrayBase
 // Serves as base class for object display
@@ -23,11 +48,14 @@ TrayBase::TrayBase(QWidget *parent):
     m_color(QColor( 0, 0, 0, 0 )),
     m_styleSheet(""),
     m_text(""),
-    m_isSelected(false),
     m_isLast(false),
     m_displayLabel(false),
     m_boldText(false),
-    m_useGradient(false)
+    m_useGradient(false),
+    m_hatched(false),
+    m_previousHatched(false),
+    m_isAlarmed(false),
+    m_alarmIndex(-1)
 {
     m_gradient.setColorAt(0.2, QColor(255,255,255,255));
     m_previousColor = m_color;
@@ -35,13 +63,34 @@ TrayBase::TrayBase(QWidget *parent):
     setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
 }
 
+TrayBase::~TrayBase()
+{
+    if (m_isAlarmed)
+        AlarmAnimator::instance()->removeWidget(this);
+}
+
+void TrayBase::setAlarmed(bool alarmed)
+{
+    if (alarmed == m_isAlarmed)
+        return;
+
+    m_isAlarmed = alarmed;
+
+    if (m_isAlarmed)
+        AlarmAnimator::instance()->addWidget(this);
+    else
+        AlarmAnimator::instance()->removeWidget(this);
+
+    update();
+}
+
 void TrayBase::setColor(QColor color)
 {
     m_color = color;
     redraw();
 }
 
-void TrayBase::setText(QString text, bool boldText, bool instantUpdate)
+void TrayBase::setText(const QString& text, bool boldText, bool instantUpdate)
 {
     m_text = text;
     m_boldText = boldText;
@@ -54,14 +103,18 @@ void TrayBase:: redraw()
     // edit styleSheet only if changed for performance
     // outside isVisible because of update issues with text
     if ( this->styleSheet().compare( m_styleSheet ) != 0)
+    {
+        PAINT_PROFILE("TrayBase::polish", QRect());
         setStyleSheet( m_styleSheet );
+    }
 
-    if ( isVisible() && m_color != m_previousColor)
+    if ( isVisible() && (m_color != m_previousColor || m_hatched != m_previousHatched))
     {
         update();
         m_previousColor = m_color;
+        m_previousHatched = m_hatched;
     }
-    else if (isVisible() && m_text != "")
+    else if (isVisible() && !m_text.isEmpty())
     {
         update();
     }
@@ -69,13 +122,14 @@ void TrayBase:: redraw()
 
 void TrayBase::paintEvent( QPaintEvent* event )
 {
-    Q_UNUSED( event );
+    PAINT_PROFILE(metaObject()->className(), event->rect());
+    TRACE_ITEM("TrayBase::paintEvent");
 
     QPainter painter( this );
 
     painter.setRenderHint( QPainter::Antialiasing);
 
-    QPen pen( QColor( "#000" ), 1, Qt::SolidLine );
+    QPen pen( Qt::black, 1, Qt::SolidLine );
     painter.setPen( pen );
 
     QRect geo(0, 0, width(), height());
@@ -90,7 +144,7 @@ void TrayBase::paintEvent( QPaintEvent* event )
         painter.fillRect(geo, m_color);
     }
 
-    if (m_text != "" && m_displayLabel)
+    if (!m_text.isEmpty() && m_displayLabel)
     {
         QRect textRect;
         QFont font;
@@ -102,7 +156,7 @@ void TrayBase::paintEvent( QPaintEvent* event )
 
         painter.setFont( font );
 
-        if( m_text.contains("\n") ) // If text has 2 lines
+        if( m_text.contains(QLatin1Char('\n')) ) // If text has 2 lines
         {
             textRect = QRect(0, height()/2-m_fontSize-6, width(), 2*(m_fontSize + 6));
         }
@@ -114,10 +168,16 @@ void TrayBase::paintEvent( QPaintEvent* event )
         painter.drawText(textRect,Qt::AlignCenter, m_text );
     }
 
+    if (m_hatched)
+        painter.fillRect(geo, hatchBrush());
+
     QStyleOption styleOpt;
     styleOpt.init(this);
     style()->drawPrimitive(QStyle::PE_Widget, &styleOpt, &painter, this);
 
+    if (m_isAlarmed && AlarmAnimator::instance()->isOn())
+        painter.fillRect(geo, ALARM_BLINK_COLOR);
+
     painter.end();
 }
 
@@ -126,7 +186,7 @@ void TrayBase::mousePressEvent(QMouseEvent *event)
     Q_UNUSED( event );
     //   qDebug() << "Click Position : " << mapToGlobal(event->pos());
     m_switchColor = m_color;
-    setColor(QColor("#5EA9F3"));
+    setColor(PRESSED_COLOR);
     emit clickPushed(m_id);
 }
 
@@ -150,45 +210,39 @@ BucketPlate::BucketPlate(QWidget* parent):
     setState(BucketState::EMPTY);
 }
 
+QColor BucketPlate::stateColor(BucketState state)
+{
+    return QColor::fromRgba(StatePalette::bucket(state));
+}
+
 void BucketPlate::setState(BucketState state)
 {
+    TRACE_ITEM("BucketPlate::setState");
 
-    m_styleSheet = "border:1px solid black; ";
+    m_color = stateColor(state);
 
-    switch ( state)
+    if (state == BucketState::DISABLED)
     {
-    case BucketState::UNKNOWN:
-        m_color = QColor(0,0,0,0);
-        m_styleSheet = "background:url(qrc:/layout/hatchedNoAlpha.png);"
-                       " border:1px solid black;";
-        break;
-    case BucketState::EMPTY:
-        m_color = QColor(0xFF,0xFF,0xFF);
-        break;
-    case BucketState::INJECTED:
-        m_color = QColor(0x99,0xCC,0xFF);
-        break;
-    case BucketState::SORTED:
-        m_color = QColor(0x73,0xE6,0x00);
-        break;
-    case BucketState::REJECTED:
-        m_color = QColor(0xFF,0x9D,0x3B);
-        break;
-    case BucketState::FAILURE:
-        m_color = QColor(0xE4,0x34,0x34);
-        break;
-    case BucketState::DISABLED:
-        m_color = QColor(0x80,0x80,0x80);
         m_previousState = m_state;
         setDisabled(true);
-        break;
-    default:;
     }
 
     m_state = state;
+    m_hatched = state == BucketState::UNKNOWN;
+    m_styleSheet = trayStyle(m_isLast);
 
-    if( !m_isLast )
-        m_styleSheet += "border-right:0;";
+    redraw();
+}
+
+void BucketPlate::showState(BucketState state)
+{
+    TRACE_ITEM("BucketPlate::showState");
+
+    m_color = stateColor(state);
+    m_state = state;
+    m_isDisabled = state == BucketState::DISABLED;
+    m_hatched = state == BucketState::UNKNOWN;
+    m_styleSheet = trayStyle(m_isLast);
 
     redraw();
 }
@@ -202,64 +256,23 @@ OutputTray::OutputTray(QWidget *parent, int id):
     TrayBase(parent)
 {
     m_displayLabel = true;
-    m_isSelected = false;
     setId(id);
     setState(OutputTrayState::ENABLED);
 }
 
-void OutputTray::deselect()
-{
-    if (isSelected())
-    {
-        setSelected(false);
-        restorePreviousState();
-        redraw();
-    }
-}
 
-void OutputTray::select()
+QColor OutputTray::stateColor(OutputTrayState state)
 {
-    if (!isSelected())
-    {
-        setSelected(true);
-        m_previousState = m_state;
-        m_color = QColor("#5E96EB");
-        redraw();
-    }
+    return QColor::fromRgba(StatePalette::output(state));
 }
 
-
 void OutputTray::setState(OutputTrayState state)
 {
     m_state = state;
+    m_color = stateColor(m_state);
+    m_styleSheet = trayStyle(m_isLast);
 
-    if(m_isSelected)
-        m_color = QColor("#5E96EB");
-    else
-    {
-        switch ( m_state )
-        {
-        case OutputTrayState::ENABLED:
-            m_color = QColor("#E1F4FF");
-            break;
-        case OutputTrayState::INHIBITED_U:
-            m_color = QColor("#8282C4");
-            break;
-        case OutputTrayState::INHIBITED_PATD:
-            m_color = QColor("#6DADAD");
-            break;
-        case OutputTrayState::INHIBITED_SD:
-            m_color = QColor("#B88C5A");
-            break;
-        default:;
-        }
-    }
-
-    m_styleSheet = "border:1px solid black; ";
-
-    if( !m_isLast )
-        m_styleSheet += "border-right:0;";
-
+    setAlarmed(StatePalette::isAlarm(m_state));
     redraw();
 }
 
@@ -268,33 +281,11 @@ void OutputTray::setLevel(ConveyorLevel level, ConveyorSide side)
     m_side = side;
     m_level = level;
 
-    if (level == ConveyorLevel::UPPER)
-    {
-        if (side == ConveyorSide::FRONT)
-        {
-            m_label = "UF\n" + QString::number(m_id);
-            m_outputId = QString::number(21001 + m_id);
-        }
-        else
-        {
-            m_label = "UB\n" + QString::number(m_id);
-            m_outputId = QString::number(22001 + m_id);
-        }
-    }
-    else
-    {
-        if (side == ConveyorSide::FRONT)
-        {
-            m_label = "LF\n" + QString::number(m_id);
-            m_outputId = QString::number(11001 + m_id);
-        }
-        else
-        {
-            m_label = "LB\n" + QString::number(m_id);
-            m_outputId = QString::number(12001 + m_id);
-        }
-    }
+    const int levelBase = level == ConveyorLevel::UPPER ? 20001 : 10001;
+    const int sideBase  = side == ConveyorSide::FRONT ? 1000 : 2000;
 
+    m_label = LabelCache::trayLabel(level, side, m_id);
+    m_outputId = LabelCache::number(levelBase + sideBase + m_id);
     m_text = m_label;
 }
 
@@ -320,7 +311,7 @@ void BcsIndicator::setPosition( int x, int y, bool flip )
 
 void BcsIndicator::paintEvent( QPaintEvent* evt )
 {
-    Q_UNUSED( evt );
+    PAINT_PROFILE("BcsIndicator", evt->rect());
     QPainter painter( this );
     painter.setPen( QPen( QColor( 0,0,0,255 ), m_borderThickness, Qt::SolidLine ) );
     painter.setBrush( QBrush( m_color ) );
@@ -375,62 +366,27 @@ TrayContainer::TrayContainer(QWidget *parent, int id):
     m_reserve(nullptr)
 {
     m_displayLabel = false;
-    m_isSelected = false;
     setId(id);
     setState(ContainerTrayState::UNKNOWN);
 }
 
-void TrayContainer::select()
-{
-    if(!isSelected())
-    {
-        setSelected(true);
-        m_previousState = m_state;
-        m_styleSheet = "border:3px solid #128AE6; background-color: rgba(18, 138, 230, 0.2);";
-        redraw();
-    }
-}
-
-void TrayContainer::deselect()
+QColor TrayContainer::stateColor(ContainerTrayState state)
 {
-    if(isSelected())
-    {
-        setSelected(false);
-        restorePreviousState();
-    }
+    return QColor::fromRgba(StatePalette::container(state));
 }
 
 void TrayContainer::setState(ContainerTrayState state)
 {
     m_state = state;
 
-    if(isSelected())
-        m_styleSheet = "border:3px solid #128AE6; background-color: rgba(18, 138, 230, 0.2);";
-    else
-        m_styleSheet = "border:1px solid black; ";
+    m_hatched = m_state == ContainerTrayState::EJECTED;
 
-    switch ( m_state )
-    {
-    case ContainerTrayState::UNKNOWN:
-        m_color = QColor("#F44242");
-        break;
-    case ContainerTrayState::EMPTY:
-        m_color = QColor("#F9F6E8");
-        break;
-    case ContainerTrayState::NOT_EMPTY:
-        m_color = QColor("#FAC191");
-        break;
-    case ContainerTrayState::EJECTED:
-        setSelected(false);
-        m_styleSheet = "background:url(qrc:/layout/hatchedNoAlpha.png);"
-                       "border:1px solid black;";
-        break;
-    default:;
-    }
+    if (!m_hatched)
+        m_color = stateColor(m_state);
 
-    if( !m_isLast && !isSelected())
-        m_styleSheet += "border-right:0;";
+    m_styleSheet = trayStyle(m_isLast);
 
+    setAlarmed(StatePalette::isAlarm(m_state));
     redraw();
 }
 
@@ -471,7 +427,8 @@ SemicircleWidget::SemicircleWidget(QWidget *parent, int distBetweenCircles, bool
 
 void SemicircleWidget::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
+    PAINT_PROFILE("SemicircleWidget", event->rect());
+    TRACE_SCOPE("SemicircleWidget::paintEvent");
 
     QPainter painter( this );
     painter.setRenderHint(QPainter::Antialiasing);
@@ -542,7 +499,8 @@ RoundedWidget::RoundedWidget(QWidget *parent, int circleWidth)
 
 void RoundedWidget::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
+    PAINT_PROFILE("RoundedWidget", event->rect());
+    TRACE_SCOPE("RoundedWidget::paintEvent");
 
     QPainter painter( this );
     QPainterPath path;
@@ -597,7 +555,8 @@ MiniLineWidget::MiniLineWidget(QWidget *parent, int line_width, int nb_buckets,
 
 void MiniLineWidget::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
+    PAINT_PROFILE("MiniLineWidget", event->rect());
+    TRACE_SCOPE("MiniLineWidget::paintEvent");
 
     QPainter painter( this );
     QPainterPath path;
@@ -636,7 +595,7 @@ void MiniLineWidget::paintEvent(QPaintEvent *event)
     for(int i = 1; i <= m_labelsNb; i++)
     {
         textRect = QRect(m_labelWidth*i-m_fontSize*2, m_lineThickness + m_levelLabelHeight, m_fontSize*4, m_separatorLabelHeight);
-        painter.drawText(textRect, Qt::AlignCenter, QString::number(100*i) );
+        painter.drawText(textRect, Qt::AlignCenter, LabelCache::number(100*i) );
     }
 
     painter.end();
@@ -658,14 +617,11 @@ ZoomLineWidget::ZoomLineWidget(QWidget *parent, int id, bool isStart, bool isEnd
 //    else
 //        label = "LC\n" + QString::number(id);
 
-    setText(QString::number(id));
+    setText(LabelCache::number(id));
 
     setFontSize(10);
     m_displayLabel = true;
 
-    m_isSelected = false;
-
-    m_selectedColor = QColor(94, 150, 235, 255);
     m_defaultColor   = QColor(109, 224, 230 ,255);
     setColor(m_defaultColor);
 
@@ -683,26 +639,6 @@ ZoomLineWidget::ZoomLineWidget(QWidget *parent, int id, bool isStart, bool isEnd
     redraw();
 }
 
-void ZoomLineWidget::deselect()
-{
-    if (isSelected() && m_isEnabled)
-    {
-        setSelected(false);
-        setColor(m_defaultColor);
-        redraw();
-    }
-}
-
-void ZoomLineWidget::select()
-{
-    if (!isSelected() && m_isEnabled)
-    {
-        setSelected(true);
-        setColor(m_selectedColor);
-        redraw();
-    }
-}
-
 void ZoomLineWidget::setDefaultColor(QColor color)
 {
     m_defaultColor = color;
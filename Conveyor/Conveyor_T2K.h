@@ -71,19 +71,23 @@ class TrayBase : public QWidget
 
 public:
    TrayBase(QWidget* parent);
+   ~TrayBase();
    int  id() { return m_id; };
-   bool isSelected(){return m_isSelected;}
+   QColor color() const { return m_color; }
 
    void setId(int id) { m_id = id; }
    void setIsLast(bool isLast) {m_isLast = isLast;};
-   void setSelected( bool selected ) {m_isSelected = selected;};
    void setColor(QColor color);
-   void setText(QString text, bool boldText = false, bool instantUpdate = true);
+   void setText(const QString& text, bool boldText = false, bool instantUpdate = true);
    void setBold(bool useBoldFont) {m_boldText = useBoldFont;};
    void displayLabel( bool display ) {m_displayLabel = display;}
    void setFontSize(int fontSize){m_fontSize = fontSize;};
    void setUseGradient(bool useGradient){ m_useGradient = useGradient;};
 
+   // Blinks with the shared alarm clock, neither the colour nor the stylesheet change
+   bool isAlarmed() const { return m_isAlarmed; }
+   void setAlarmed(bool alarmed);
+
    void redraw();
 
 protected:
@@ -100,11 +104,17 @@ protected:
    QColor m_switchColor;
    QString m_styleSheet;
    QString m_text;
-   bool m_isSelected;
    bool m_isLast;
    bool m_displayLabel;
    bool m_boldText;
    bool m_useGradient;
+   bool m_hatched;            // painted over the colour, UNKNOWN buckets and ejected containers
+   bool m_previousHatched;
+   bool m_isAlarmed;
+
+private:
+   friend class AlarmAnimator;
+   int  m_alarmIndex;       // position in the AlarmAnimator array, -1 when not blinking
 
 signals:
    void clickReleased(int id);
@@ -136,6 +146,12 @@ public:
 
    void restorePreviousState(){ setState(m_previousState); };
 
+   // Slot of a rotating synoptic : shows the state of the bucket passing by, the plate is
+   // disabled only while it shows a disabled bucket and its previous state is untouched
+   void showState(BucketState state);
+
+   static QColor stateColor(BucketState state);
+
 private:
    ConveyorSide m_side;
    ConveyorLevel m_level;
@@ -160,23 +176,20 @@ public:
    OutputTray(QWidget* parent, int id);
 
    OutputTrayState   state() { return m_state; }
-   OutputTrayState   previousState() { return m_previousState; }
    ConveyorSide      side() {return m_side;};
    ConveyorLevel     level() {return m_level;};
    QString           outputId(){return m_outputId;};
 
-   void deselect();
-   void select();
    void setState(OutputTrayState state);
    void setLevel(ConveyorLevel level, ConveyorSide side);
 
-   void restorePreviousState(){ setState(m_previousState); };
+   // Selection is a SelectionModel drawn by OutputWall, a tray has none of its own
+   static QColor stateColor(OutputTrayState state);
 
 private:
    ConveyorSide      m_side;
    ConveyorLevel     m_level;
    OutputTrayState   m_state;
-   OutputTrayState   m_previousState;
    QString           m_label;
    QString           m_outputId;
 };
@@ -229,22 +242,21 @@ public:
    QString              sortingProduct() const {return m_sortingProduct;};
    QString              trayId() const {return m_trayId;};
 
-   void select();
-   void deselect();
-
+   // Selection is a SelectionModel drawn by ContainerWall, a tray has none of its own
    void setState(ContainerTrayState state);
    void setLevel(ConveyorLevel level, ConveyorSide side);
    void setReserve(TrayReserve* reserve){m_reserve = reserve;};
-   void restorePreviousState(){ setState(m_previousState); };
    void setOutput(QString output){m_output = output;};
    void setSortingProduct(QString sortingProduct){m_sortingProduct = sortingProduct;};
    void setTrayId(QString trayId){m_trayId = trayId;};
 
+   // Background colour, an ejected container is painted hatched over the empty colour
+   static QColor stateColor(ContainerTrayState state);
+
 private:
    ConveyorSide         m_side;
    ConveyorLevel        m_level;
    ContainerTrayState   m_state;
-   ContainerTrayState   m_previousState;
    TrayReserve*         m_reserve;
    QString              m_trayId;
    QString              m_sortingProduct;
@@ -374,14 +386,11 @@ class ZoomLineWidget : public TrayBase
 
 public:
    ZoomLineWidget(QWidget *parent, int id, bool isStart, bool isEnd);
-   void deselect();
-   void select();
    void enable(bool enable){m_isEnabled = enable;};
    void setDefaultColor(QColor color);
 private:
    bool     m_isEnabled;
    bool     m_isStart;
-   QColor   m_selectedColor;
    QColor   m_defaultColor;
 };
 
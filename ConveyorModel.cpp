@@ -0,0 +1,342 @@
+#include "ConveyorModel.h"
+#include "TraceRecorder.h"
+#include <QTimer>
+#include <algorithm>
+
+ConveyorModel::ConveyorModel(int outputsPerSide, QObject *parent)
+    : QObject{parent},
+      m_outputsPerSide(qBound(1, outputsPerSide, CONVEYOR_MAX_OUTPUTS_PER_SIDE)),
+      m_outputStates(trayCount(), static_cast<quint8>(OutputTrayState::ENABLED)),
+      m_containerStates(trayCount(), static_cast<quint8>(ContainerTrayState::UNKNOWN)),
+      m_reserves(trayCount(), 0),
+      m_products(trayCount(), -1),
+      m_trayIds(trayCount()),
+      m_flushScheduled(false)
+{
+}
+
+int ConveyorModel::lineOf(ConveyorLevel level, ConveyorSide side)
+{
+    const int levelRow = level == ConveyorLevel::UPPER ? 0 : 1;
+    const int sideRow  = side == ConveyorSide::BACK ? 0 : 1;
+
+    return 2*levelRow + sideRow;
+}
+
+int ConveyorModel::trayIndex(ConveyorLevel level, ConveyorSide side, int index) const
+{
+    if (level == ConveyorLevel::BOTH || index < 0 || index >= m_outputsPerSide)
+        return -1;
+
+    return lineOf(level, side)*m_outputsPerSide + index;
+}
+
+// 21001 + i : upper front, 22001 + i : upper back, 11001 + i : lower front, 12001 + i : lower back
+int ConveyorModel::outputIndex(int outputId) const
+{
+    const int levelDigit = outputId/10000;
+    const int sideDigit  = (outputId/1000) % 10;
+    const int index      = outputId % 1000 - 1;
+
+    if (levelDigit < 1 || levelDigit > 2 || sideDigit < 1 || sideDigit > 2)
+        return -1;
+
+    return trayIndex(levelDigit == 2 ? ConveyorLevel::UPPER : ConveyorLevel::LOWER,
+                     sideDigit == 1 ? ConveyorSide::FRONT : ConveyorSide::BACK,
+                     index);
+}
+
+int ConveyorModel::outputId(ConveyorLevel level, ConveyorSide side, int index)
+{
+    return (level == ConveyorLevel::UPPER ? 20000 : 10000)
+         + (side == ConveyorSide::FRONT ? 1000 : 2000)
+         + 1 + index;
+}
+
+// Ranges already pending are merged, field by field
+void ConveyorModel::markChanged(Part part, int first, int last, int fields)
+{
+    if (first > last)
+        return;
+
+    for (int bit = 0; bit < CONVEYOR_FIELD_COUNT; bit++)
+    {
+        if (fields & (1 << bit))
+            m_pending[part].ranges[bit].insert(first, last);
+    }
+
+    m_pending[part].fields |= fields;
+
+    if (!m_flushScheduled)
+    {
+        m_flushScheduled = true;
+        QTimer::singleShot(0, this, &ConveyorModel::flush);
+    }
+}
+
+// Sweep over the bounds of the pending ranges of every field : between two bounds the mask
+// is constant, neighbour segments with the same mask are joined
+QVector<ConveyorModel::Batch> ConveyorModel::takeBatches(Part part, int size)
+{
+    Pending& pending = m_pending[part];
+    QVector<IntervalSet::Interval> ranges[CONVEYOR_FIELD_COUNT];
+    QVector<int> bounds;
+    QVector<Batch> batches;
+
+    for (int bit = 0; bit < CONVEYOR_FIELD_COUNT; bit++)
+    {
+        if (!(pending.fields & (1 << bit)))
+            continue;
+
+        ranges[bit] = pending.ranges[bit].intervals(0, size - 1);
+        pending.ranges[bit].clear();
+
+        for (const IntervalSet::Interval& range : qAsConst(ranges[bit]))
+            bounds << range.first << range.second + 1;
+    }
+
+    pending.fields = 0;
+
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    int next[CONVEYOR_FIELD_COUNT] = {};
+
+    for (int i = 0; i + 1 < bounds.size(); i++)
+    {
+        const int first = bounds[i];
+        int fields = 0;
+
+        for (int bit = 0; bit < CONVEYOR_FIELD_COUNT; bit++)
+        {
+            const QVector<IntervalSet::Interval>& bitRanges = ranges[bit];
+
+            while (next[bit] < bitRanges.size() && bitRanges[next[bit]].second < first)
+                next[bit]++;
+
+            if (next[bit] < bitRanges.size() && bitRanges[next[bit]].first <= first)
+                fields |= 1 << bit;
+        }
+
+        if (fields == 0)
+            continue;
+
+        if (!batches.isEmpty() && batches.last().fields == fields && batches.last().last == first - 1)
+            batches.last().last = bounds[i + 1] - 1;
+        else
+            batches.append({ first, bounds[i + 1] - 1, fields });
+    }
+
+    return batches;
+}
+
+// The pending batches are taken first : a view writing back from its slot starts the next one
+void ConveyorModel::flush()
+{
+    TRACE_SCOPE("ConveyorModel::flush");
+
+    m_flushScheduled = false;
+
+    const QVector<Batch> outputs    = takeBatches(OUTPUTS, trayCount());
+    const QVector<Batch> containers = takeBatches(CONTAINERS, trayCount());
+
+    for (const Batch& batch : outputs)
+        emit outputsChanged(batch.first, batch.last, batch.fields);
+
+    for (const Batch& batch : containers)
+        emit containersChanged(batch.first, batch.last, batch.fields);
+}
+
+void ConveyorModel::setOutputState(ConveyorLevel level, ConveyorSide side, int index, OutputTrayState state)
+{
+    setOutputStateRange(level, side, index, index, state);
+}
+
+bool ConveyorModel::setOutputState(int outputId, OutputTrayState state)
+{
+    const int tray = outputIndex(outputId);
+
+    if (tray < 0)
+        return false;
+
+    if (m_outputStates[tray] != static_cast<quint8>(state))
+    {
+        m_outputStates[tray] = static_cast<quint8>(state);
+        markChanged(OUTPUTS, tray, tray, FIELD_OUTPUT_STATE);
+    }
+
+    return true;
+}
+
+void ConveyorModel::setOutputStateRange(ConveyorLevel level, ConveyorSide side, int first, int last, OutputTrayState state)
+{
+    if (level == ConveyorLevel::BOTH)
+        return;
+
+    first = qMax(first, 0);
+    last  = qMin(last, m_outputsPerSide - 1);
+
+    if (first > last)
+        return;
+
+    const int lineStart = lineOf(level, side)*m_outputsPerSide;
+    const quint8 packed = static_cast<quint8>(state);
+    quint8* states = m_outputStates.data() + lineStart;
+    int changedFirst = -1;
+    int changedLast = -1;
+
+    for (int i = first; i <= last; i++)
+    {
+        if (states[i] == packed)
+            continue;
+
+        states[i] = packed;
+
+        if (changedFirst < 0)
+            changedFirst = i;
+        changedLast = i;
+    }
+
+    if (changedFirst >= 0)
+        markChanged(OUTPUTS, lineStart + changedFirst, lineStart + changedLast, FIELD_OUTPUT_STATE);
+}
+
+bool ConveyorModel::setOutputStates(const QVector<quint8>& states)
+{
+    if (states.size() != m_outputStates.size() ||
+        !std::all_of(states.cbegin(), states.cend(), [](quint8 state) { return state < OUTPUT_TRAY_STATE_COUNT; }))
+        return false;
+
+    m_outputStates = states;
+    markChanged(OUTPUTS, 0, trayCount() - 1, FIELD_OUTPUT_STATE);
+    return true;
+}
+
+QString ConveyorModel::sortingProduct(int tray) const
+{
+    const int product = m_products[tray];
+    return product < 0 ? QString() : m_productNames[product];
+}
+
+QVector<int> ConveyorModel::containersOfProduct(const QString& sortingProduct) const
+{
+    const int product = m_productIds.value(sortingProduct, -1);
+
+    if (product < 0)
+        return QVector<int>();
+
+    return m_containersOfProduct[product];
+}
+
+int ConveyorModel::internProduct(const QString& sortingProduct)
+{
+    auto it = m_productIds.constFind(sortingProduct);
+
+    if (it != m_productIds.constEnd())
+        return it.value();
+
+    const int product = m_productNames.size();
+    m_productNames.append(sortingProduct);
+    m_containersOfProduct.append(QVector<int>());
+    m_productIds.insert(sortingProduct, product);
+
+    return product;
+}
+
+void ConveyorModel::setContainerState(ConveyorLevel level, ConveyorSide side, int index, ContainerTrayState state)
+{
+    const int tray = trayIndex(level, side, index);
+
+    if (tray < 0 || m_containerStates[tray] == static_cast<quint8>(state))
+        return;
+
+    m_containerStates[tray] = static_cast<quint8>(state);
+    markChanged(CONTAINERS, tray, tray, FIELD_CONTAINER_STATE);
+}
+
+void ConveyorModel::setReservePresent(ConveyorLevel level, ConveyorSide side, int index, bool present)
+{
+    const int tray = trayIndex(level, side, index);
+
+    if (tray < 0 || (m_reserves[tray] != 0) == present)
+        return;
+
+    m_reserves[tray] = present ? 1 : 0;
+    markChanged(CONTAINERS, tray, tray, FIELD_CONTAINER_RESERVE);
+}
+
+void ConveyorModel::setSortingProduct(ConveyorLevel level, ConveyorSide side, int index, const QString& sortingProduct)
+{
+    const int tray = trayIndex(level, side, index);
+
+    if (tray < 0)
+        return;
+
+    const int previous = m_products[tray];
+    const int product = sortingProduct.isEmpty() ? -1 : internProduct(sortingProduct);
+
+    if (previous == product)
+        return;
+
+    if (previous >= 0)
+        m_containersOfProduct[previous].removeOne(tray);
+
+    if (product >= 0)
+        m_containersOfProduct[product].append(tray);
+
+    m_products[tray] = product;
+    markChanged(CONTAINERS, tray, tray, FIELD_CONTAINER_PRODUCT);
+}
+
+void ConveyorModel::setTrayId(ConveyorLevel level, ConveyorSide side, int index, const QString& trayId)
+{
+    const int tray = trayIndex(level, side, index);
+
+    if (tray < 0 || m_trayIds[tray] == trayId)
+        return;
+
+    if (!m_trayIds[tray].isEmpty())
+        m_trayIndex.remove(m_trayIds[tray]);
+
+    if (!trayId.isEmpty())
+        m_trayIndex.insert(trayId, tray);
+
+    m_trayIds[tray] = trayId;
+    markChanged(CONTAINERS, tray, tray, FIELD_CONTAINER_TRAY_ID);
+}
+
+int ConveyorModel::ejectProduct(const QString& sortingProduct)
+{
+    const int product = m_productIds.value(sortingProduct, -1);
+
+    if (product < 0)
+        return 0;
+
+    const quint8 ejected = static_cast<quint8>(ContainerTrayState::EJECTED);
+    int count = 0;
+
+    for (int tray : qAsConst(m_containersOfProduct[product]))
+    {
+        if (m_containerStates[tray] == ejected)
+            continue;
+
+        m_containerStates[tray] = ejected;
+        markChanged(CONTAINERS, tray, tray, FIELD_CONTAINER_STATE);
+        count++;
+    }
+
+    return count;
+}
+
+// Rejected as a whole if the sizes or any state do not fit (snapshots)
+bool ConveyorModel::setContainerStates(const QVector<quint8>& states, const QVector<quint8>& reserves)
+{
+    if (states.size() != m_containerStates.size() || reserves.size() != m_reserves.size() ||
+        !std::all_of(states.cbegin(), states.cend(), [](quint8 state) { return state < CONTAINER_TRAY_STATE_COUNT; }))
+        return false;
+
+    m_containerStates = states;
+    m_reserves = reserves;
+    markChanged(CONTAINERS, 0, trayCount() - 1, FIELD_CONTAINER_STATE | FIELD_CONTAINER_RESERVE);
+    return true;
+}
@@ -0,0 +1,141 @@
+#ifndef CONVEYORMODEL_H
+#define CONVEYORMODEL_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QString>
+#include "CarouselModel.h"
+#include "IntervalSet.h"
+#include "StatePalette.h"
+
+static const int CONVEYOR_TRAY_LINES           = 4;        // UB, UF, LB, LF
+static const int CONVEYOR_MAX_OUTPUTS_PER_SIDE = 999;      // above, the output ids overlap the next line
+
+// Bits of the fields argument of the ConveyorModel notifications
+enum ConveyorField
+{
+    FIELD_OUTPUT_STATE      = 0x01,
+    FIELD_CONTAINER_STATE   = 0x02,
+    FIELD_CONTAINER_RESERVE = 0x04,
+    FIELD_CONTAINER_PRODUCT = 0x08,
+    FIELD_CONTAINER_TRAY_ID = 0x10
+};
+
+static const int CONVEYOR_FIELD_COUNT = 5;
+
+//---------------------------------------------------------------------------------------
+// class ConveyorModel
+// Tray data of the conveyor shared by the walls : the output trays, and the containers with
+// their reserve, sorting product and tray id. Trays are stored line after line (UB, UF, LB,
+// LF) in packed columns. The buckets stay in CarouselModel, which notifies its carousel
+// views synchronously.
+// Writes are only recorded as ranges per changed field; they are notified once at the next
+// event loop turn, one signal per disjoint range carrying the fields changed over exactly
+// that range, so a burst of transitions repaints each view once and only what changed.
+//---------------------------------------------------------------------------------------
+
+class ConveyorModel : public QObject
+{
+    Q_OBJECT
+public:
+    ConveyorModel(int outputsPerSide, QObject *parent = nullptr);
+
+    int  outputsPerSide() const { return m_outputsPerSide; }
+    int  trayCount() const { return CONVEYOR_TRAY_LINES*m_outputsPerSide; }
+
+    // Row of a level and side, upper level first, back side above front side
+    static int lineOf(ConveyorLevel level, ConveyorSide side);
+
+    // Tray index in the columns, -1 if the tray does not exist
+    int  trayIndex(ConveyorLevel level, ConveyorSide side, int index) const;
+    int  outputIndex(int outputId) const;
+    static int outputId(ConveyorLevel level, ConveyorSide side, int index);
+
+    // Outputs
+    OutputTrayState outputState(int tray) const { return static_cast<OutputTrayState>(m_outputStates[tray]); }
+    bool            isOutputAlarmed(int tray) const { return StatePalette::isAlarm(outputState(tray)); }
+    const QVector<quint8>& outputStates() const { return m_outputStates; }
+
+    // Same signature as SorterSimulator::outputStateChanged
+    void setOutputState(ConveyorLevel level, ConveyorSide side, int index, OutputTrayState state);
+    bool setOutputState(int outputId, OutputTrayState state);
+    void setOutputStateRange(ConveyorLevel level, ConveyorSide side, int first, int last, OutputTrayState state);
+
+    // Rejected as a whole if the size or any state does not fit (snapshots)
+    bool setOutputStates(const QVector<quint8>& states);
+
+    // Containers
+    ContainerTrayState containerState(int tray) const { return static_cast<ContainerTrayState>(m_containerStates[tray]); }
+    bool               isReservePresent(int tray) const { return m_reserves[tray] != 0; }
+    QString            sortingProduct(int tray) const;
+    QString            trayId(int tray) const { return m_trayIds[tray]; }
+    bool               isContainerAlarmed(int tray) const { return StatePalette::isAlarm(containerState(tray)); }
+
+    int          indexOfTray(const QString& trayId) const { return m_trayIndex.value(trayId, -1); }
+    QVector<int> containersOfProduct(const QString& sortingProduct) const;
+
+    const QVector<quint8>& containerStates() const { return m_containerStates; }
+    const QVector<quint8>& reserves() const { return m_reserves; }
+
+    // Same signature as SorterSimulator::containerStateChanged
+    void setContainerState(ConveyorLevel level, ConveyorSide side, int index, ContainerTrayState state);
+    void setReservePresent(ConveyorLevel level, ConveyorSide side, int index, bool present);
+    void setSortingProduct(ConveyorLevel level, ConveyorSide side, int index, const QString& sortingProduct);
+    void setTrayId(ConveyorLevel level, ConveyorSide side, int index, const QString& trayId);
+
+    // Ejects every container sorting the product. Returns the number ejected
+    int  ejectProduct(const QString& sortingProduct);
+
+    bool setContainerStates(const QVector<quint8>& states, const QVector<quint8>& reserves);
+
+signals:
+    // Inclusive ranges of tray indices, fields is a mask of ConveyorField
+    void outputsChanged(int first, int last, int fields);
+    void containersChanged(int first, int last, int fields);
+
+private slots:
+    void flush();
+
+private:
+    enum Part { OUTPUTS, CONTAINERS, PART_COUNT };
+
+    // Ranges of each field bit, fields is the union of the bits pending
+    struct Pending
+    {
+        IntervalSet ranges[CONVEYOR_FIELD_COUNT];
+        int         fields = 0;
+    };
+
+    struct Batch
+    {
+        int first;
+        int last;
+        int fields;
+    };
+
+    void markChanged(Part part, int first, int last, int fields);
+    QVector<Batch> takeBatches(Part part, int size);
+    int  internProduct(const QString& sortingProduct);
+
+private:
+    int                         m_outputsPerSide;
+
+    QVector<quint8>             m_outputStates;
+
+    // Container columns
+    QVector<quint8>             m_containerStates;
+    QVector<quint8>             m_reserves;
+    QVector<int>                m_products;         // interned, -1 without product
+    QVector<QString>            m_trayIds;
+
+    QVector<QString>            m_productNames;
+    QHash<QString, int>         m_productIds;
+    QVector<QVector<int>>       m_containersOfProduct;
+    QHash<QString, int>         m_trayIndex;
+
+    Pending                     m_pending[PART_COUNT];
+    bool                        m_flushScheduled;
+};
+
+#endif // CONVEYORMODEL_H
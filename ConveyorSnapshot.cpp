@@ -0,0 +1,243 @@
+#include "ConveyorSnapshot.h"
+#include "TraceRecorder.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QDebug>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <cstring>
+
+static size_t paddedSize(size_t size) { return (size + 7) & ~size_t(7); }
+
+// Corrupted or newer files must never put an out of range state into a model
+static bool fits(const uchar* data, quint32 size, int stateCount)
+{
+    return std::all_of(data, data + size, [stateCount](uchar state) { return state < stateCount; });
+}
+
+static QVector<quint8> toVector(const uchar* data, quint32 size)
+{
+    QVector<quint8> states(int(size));
+    std::memcpy(states.data(), data, size);
+    return states;
+}
+
+ConveyorSnapshot::ConveyorSnapshot(const QString& fileName, QObject *parent)
+    : QObject{parent},
+      m_fileName(fileName),
+      m_conveyor(nullptr),
+      m_scheduler(new FrameScheduler(SNAPSHOT_INTERVAL, SNAPSHOT_IDLE_INTERVAL, this))
+{
+    connect(m_scheduler, &FrameScheduler::frame, this, &ConveyorSnapshot::on_frame);
+    connect(&m_watcher, &QFutureWatcherBase::finished, this, &ConveyorSnapshot::on_writeFinished);
+}
+
+// The last write is finished so the file is never left as a temporary
+ConveyorSnapshot::~ConveyorSnapshot()
+{
+    m_watcher.waitForFinished();
+}
+
+void ConveyorSnapshot::addCarousel(CarouselModel* model)
+{
+    m_carousels.append(model);
+
+    // Any change brings the next write forward
+    connect(model, &CarouselModel::bucketsChanged, m_scheduler, &FrameScheduler::wake);
+    connect(model, &CarouselModel::positionChanged, m_scheduler, &FrameScheduler::wake);
+}
+
+// Product and tray id changes are not saved, they do not wake the writer
+void ConveyorSnapshot::setConveyorModel(ConveyorModel* conveyor)
+{
+    m_conveyor = conveyor;
+
+    connect(conveyor, &ConveyorModel::outputsChanged, m_scheduler, &FrameScheduler::wake);
+    connect(conveyor, &ConveyorModel::containersChanged, this, [this](int, int, int fields)
+    {
+        if (fields & (FIELD_CONTAINER_STATE | FIELD_CONTAINER_RESERVE))
+            m_scheduler->wake();
+    });
+}
+
+void ConveyorSnapshot::start()
+{
+    m_scheduler->start();
+}
+
+void ConveyorSnapshot::stop()
+{
+    m_scheduler->stop();
+}
+
+// Shared copies only : the views detach on their next write
+QVector<ConveyorSnapshot::Section> ConveyorSnapshot::collect() const
+{
+    QVector<Section> sections;
+
+    for (int i = 0; i < m_carousels.size(); i++)
+        sections.append({SNAPSHOT_BUCKETS, i, m_carousels[i]->position(), m_carousels[i]->states()});
+
+    if (m_conveyor)
+    {
+        sections.append({SNAPSHOT_OUTPUTS, 0, 0, m_conveyor->outputStates()});
+        sections.append({SNAPSHOT_CONTAINERS, 0, 0, m_conveyor->containerStates()});
+        sections.append({SNAPSHOT_RESERVES, 0, 0, m_conveyor->reserves()});
+    }
+
+    return sections;
+}
+
+void ConveyorSnapshot::on_frame()
+{
+    // Still writing : try again on the next frame
+    if (m_watcher.isRunning())
+    {
+        m_scheduler->markBusy();
+        return;
+    }
+
+    const QVector<Section> sections = collect();
+
+    // Unchanged arrays still share their data with the last written ones, the comparison is immediate
+    bool changed = sections.size() != m_written.size();
+
+    for (int i = 0; !changed && i < sections.size(); i++)
+        changed = sections[i].position != m_written[i].position || sections[i].data != m_written[i].data;
+
+    if (!changed)
+        return;
+
+    m_writing = sections;
+    m_scheduler->markBusy();
+
+    const QString fileName = m_fileName;
+    m_watcher.setFuture(QtConcurrent::run([fileName, sections]() { return write(fileName, sections); }));
+}
+
+// The file holds the sections only once committed : a failed write leaves them pending
+// and the next frame writes them again
+void ConveyorSnapshot::on_writeFinished()
+{
+    const bool ok = m_watcher.result();
+
+    if (ok)
+        m_written = m_writing;
+    else
+        m_scheduler->wake();
+
+    m_writing.clear();
+    emit written(ok);
+}
+
+// Pool thread. QSaveFile renames on commit : a crash never leaves a partial snapshot
+bool ConveyorSnapshot::write(const QString& fileName, const QVector<Section>& sections)
+{
+    TRACE_SCOPE("ConveyorSnapshot::write");
+
+    static const char padding[8] = {};
+
+    QSaveFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    const SnapshotHeader header = { SNAPSHOT_MAGIC, SNAPSHOT_VERSION, quint16(sections.size()),
+                                    QDateTime::currentMSecsSinceEpoch() };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const Section& section : sections)
+    {
+        const quint32 size = quint32(section.data.size());
+        const SnapshotSection sectionHeader = { quint32(section.type), quint32(section.key), qint32(section.position), size };
+
+        file.write(reinterpret_cast<const char*>(&sectionHeader), sizeof(sectionHeader));
+        file.write(reinterpret_cast<const char*>(section.data.constData()), size);
+        file.write(padding, qint64(paddedSize(size) - size));
+    }
+
+    if (!file.commit())
+    {
+        qWarning() << "Cannot write snapshot" << fileName << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool ConveyorSnapshot::restore()
+{
+    TRACE_SCOPE("ConveyorSnapshot::restore");
+
+    QFile file(m_fileName);
+
+    if (!file.open(QIODevice::ReadOnly) || file.size() < qint64(sizeof(SnapshotHeader)))
+        return false;
+
+    const qint64 fileSize = file.size();
+    uchar* map = file.map(0, fileSize);
+
+    if (!map)
+        return false;
+
+    SnapshotHeader header;
+    std::memcpy(&header, map, sizeof(header));
+
+    if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION)
+    {
+        qWarning() << "Ignoring snapshot" << m_fileName << "of version" << header.version;
+        file.unmap(map);
+        return false;
+    }
+
+    QVector<quint8> containerStates;
+    QVector<quint8> reserves;
+    qint64 offset = sizeof(SnapshotHeader);
+
+    for (int i = 0; i < header.sectionCount; i++)
+    {
+        if (offset + qint64(sizeof(SnapshotSection)) > fileSize)
+            break;
+
+        SnapshotSection section;
+        std::memcpy(&section, map + offset, sizeof(section));
+        offset += sizeof(SnapshotSection);
+
+        if (offset + qint64(section.size) > fileSize)
+            break;
+
+        const uchar* data = map + offset;
+        offset += qint64(paddedSize(section.size));
+
+        switch (section.type)
+        {
+        case SNAPSHOT_BUCKETS:
+            if (section.key < quint32(m_carousels.size()) &&
+                int(section.size) == m_carousels[int(section.key)]->bucketCount() &&
+                fits(data, section.size, BUCKET_STATE_COUNT))
+                m_carousels[int(section.key)]->setStates(toVector(data, section.size), section.position);
+            break;
+        case SNAPSHOT_OUTPUTS:
+            if (m_conveyor && fits(data, section.size, OUTPUT_TRAY_STATE_COUNT))
+                m_conveyor->setOutputStates(toVector(data, section.size));
+            break;
+        case SNAPSHOT_CONTAINERS:
+            containerStates = toVector(data, section.size);
+            break;
+        case SNAPSHOT_RESERVES:
+            reserves = toVector(data, section.size);
+            break;
+        default:;      // written by a later version, skipped
+        }
+    }
+
+    if (m_conveyor && !containerStates.isEmpty())
+        m_conveyor->setContainerStates(containerStates, reserves);
+
+    file.unmap(map);
+
+    // What was restored is what the file holds : no write until something changes
+    m_written = collect();
+    return true;
+}
@@ -0,0 +1,104 @@
+#ifndef CONVEYORSNAPSHOT_H
+#define CONVEYORSNAPSHOT_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QFutureWatcher>
+#include "ConveyorModel.h"
+#include "FrameScheduler.h"
+
+// Snapshot file header, followed by sectionCount sections
+struct SnapshotHeader
+{
+    quint32 magic;
+    quint16 version;
+    quint16 sectionCount;
+    qint64  timestamp;          // ms since epoch
+};
+
+// Section header, followed by size bytes padded to 8
+struct SnapshotSection
+{
+    quint32 type;
+    quint32 key;                // carousel registration order, 0 for the walls
+    qint32  position;           // BCS position of a carousel
+    quint32 size;
+};
+
+static_assert(sizeof(SnapshotHeader) == 16, "SnapshotHeader must stay 16 bytes");
+static_assert(sizeof(SnapshotSection) == 16, "SnapshotSection must stay 16 bytes");
+
+static const quint32 SNAPSHOT_MAGIC   = 0x50534E43;     // "CNSP"
+static const quint16 SNAPSHOT_VERSION = 1;
+
+enum SnapshotSectionType
+{
+    SNAPSHOT_BUCKETS    = 1,    // one byte per bucket id
+    SNAPSHOT_OUTPUTS    = 2,    // ConveyorModel output states
+    SNAPSHOT_CONTAINERS = 3,    // ConveyorModel container states
+    SNAPSHOT_RESERVES   = 4     // ConveyorModel reserve presence
+};
+
+//---------------------------------------------------------------------------------------
+// class ConveyorSnapshot
+// Last known state of the whole conveyor, so a restarted HMI shows it on its first frame
+// instead of defaults until the PLC resends everything. The packed arrays are taken as
+// shared copies on the GUI thread and written by a pool thread through QSaveFile, only
+// when something changed. restore() maps the file and copies each section straight into
+// its model.
+//---------------------------------------------------------------------------------------
+
+static const int SNAPSHOT_INTERVAL      = 2000;     // ms between two writes of a changing conveyor
+static const int SNAPSHOT_IDLE_INTERVAL = 0;        // every model notifies its changes, an idle conveyor stops the clock
+
+class ConveyorSnapshot : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConveyorSnapshot(const QString& fileName, QObject *parent = nullptr);
+    ~ConveyorSnapshot();
+
+    // Registration order is the carousel key in the file, none of the models is owned
+    void addCarousel(CarouselModel* model);
+    void setConveyorModel(ConveyorModel* conveyor);
+
+    // Applies the last snapshot to the registered models. Sections not matching them
+    // (other bucket count, unknown state) are skipped. False if the file is unusable.
+    bool restore();
+
+    void start();
+    void stop();
+
+signals:
+    // After each write; a failed one is retried on the next frame
+    void written(bool ok);
+
+private slots:
+    void on_frame();
+    void on_writeFinished();
+
+private:
+    struct Section
+    {
+        SnapshotSectionType type;
+        int                 key;
+        int                 position;
+        QVector<quint8>     data;
+    };
+
+    QVector<Section> collect() const;
+    static bool      write(const QString& fileName, const QVector<Section>& sections);
+
+private:
+    QString                 m_fileName;
+    QVector<CarouselModel*> m_carousels;
+    ConveyorModel*          m_conveyor;         // outputs and containers
+
+    FrameScheduler*         m_scheduler;
+    QFutureWatcher<bool>    m_watcher;
+    QVector<Section>        m_writing;          // sections handed to the writer
+    QVector<Section>        m_written;          // last sections in the file
+};
+
+#endif // CONVEYORSNAPSHOT_H
@@ -0,0 +1,69 @@
+#include "FrameScheduler.h"
+
+quint64 FrameScheduler::s_wakeups = 0;
+
+FrameScheduler::FrameScheduler(int frameInterval, int idleInterval, QObject *parent)
+    : QObject{parent},
+      m_timer(new QTimer(this)),
+      m_frameInterval(qMax(frameInterval, 1)),
+      m_idleInterval(qMax(idleInterval, 0)),
+      m_interval(m_frameInterval),
+      m_busy(false),
+      m_stopped(true)
+{
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &FrameScheduler::on_timeout);
+}
+
+void FrameScheduler::start()
+{
+    m_stopped = false;
+    m_interval = m_frameInterval;
+    m_timer->start(m_interval);
+}
+
+void FrameScheduler::stop()
+{
+    m_stopped = true;
+    m_timer->stop();
+}
+
+// Called on every event : only the first one after an idle period moves the timer
+void FrameScheduler::wake()
+{
+    m_stopped = false;
+    m_interval = m_frameInterval;
+
+    const qint64 sinceLastFrame = m_lastFrame.isValid() ? m_lastFrame.elapsed() : m_frameInterval;
+    const int delay = int(qBound<qint64>(0, m_frameInterval - sinceLastFrame, m_frameInterval));
+
+    if (m_timer->isActive() && m_timer->remainingTime() <= delay)
+        return;
+
+    m_timer->start(delay);
+}
+
+void FrameScheduler::on_timeout()
+{
+    s_wakeups++;
+    m_lastFrame.start();
+    m_busy = false;
+
+    emit frame();
+
+    // The client may have stopped the clock or woken it from frame()
+    if (m_stopped || m_timer->isActive())
+        return;
+
+    if (m_busy)
+        m_interval = m_frameInterval;
+    else if (m_idleInterval == 0)
+    {
+        m_stopped = true;
+        return;
+    }
+    else
+        m_interval = qMin(2*m_interval, m_idleInterval);
+
+    m_timer->start(m_interval);
+}
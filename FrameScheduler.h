@@ -0,0 +1,54 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+//---------------------------------------------------------------------------------------
+// class FrameScheduler
+// Frame clock following the activity of its client. Frames come at the full rate as long
+// as the client calls markBusy() from frame(); after an idle frame the interval doubles
+// up to the idle interval, or the clock stops when the idle interval is 0 (clients told
+// of every change). wake() brings the full rate back at once, without ever running two
+// frames closer than the frame interval.
+//---------------------------------------------------------------------------------------
+
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    FrameScheduler(int frameInterval, int idleInterval, QObject *parent = nullptr);
+
+    int  interval() const { return m_interval; }
+    bool isRunning() const { return m_timer->isActive(); }
+
+    void start();
+    void stop();
+    void wake();
+
+    // From frame() only : the frame did some work, stay at the full rate
+    void markBusy() { m_busy = true; }
+
+    // Frames run by all the schedulers since the start, for the wakeup measurements
+    static quint64 wakeupCount() { return s_wakeups; }
+
+signals:
+    void frame();
+
+private slots:
+    void on_timeout();
+
+private:
+    QTimer*         m_timer;
+    QElapsedTimer   m_lastFrame;
+    int             m_frameInterval;
+    int             m_idleInterval;
+    int             m_interval;
+    bool            m_busy;
+    bool            m_stopped;
+
+    static quint64  s_wakeups;
+};
+
+#endif // FRAMESCHEDULER_H
@@ -0,0 +1,94 @@
+#include "HistoryScrubber.h"
+#include <QHBoxLayout>
+#include <QDateTime>
+#include <QSignalBlocker>
+
+HistoryScrubber::HistoryScrubber(CarouselHistory* history, BasicCarousel* carousel, QWidget *parent)
+    : QWidget{parent},
+      m_history(history),
+      m_carousel(carousel),
+      m_liveModel(carousel->model())
+{
+    m_historyModel = new CarouselModel(m_liveModel->bucketCount(), this);
+
+    m_slider = new QSlider(Qt::Horizontal, this);
+    m_slider->setTracking(true);
+
+    m_timeLabel = new QLabel(this);
+    m_timeLabel->setFixedWidth(60);
+
+    m_liveBtn = new QPushButton("Live", this);
+    m_liveBtn->setEnabled(false);
+
+    QHBoxLayout* layout = new QHBoxLayout(this);
+    layout->setMargin(0);
+    layout->addWidget(m_slider);
+    layout->addWidget(m_timeLabel);
+    layout->addWidget(m_liveBtn);
+    setLayout(layout);
+
+    connect(m_slider, &QSlider::sliderPressed, this, &HistoryScrubber::on_sliderPressed);
+    connect(m_slider, &QSlider::actionTriggered, this, &HistoryScrubber::on_sliderAction);
+    connect(m_slider, &QSlider::valueChanged, this, &HistoryScrubber::on_valueChanged);
+    connect(m_liveBtn, &QPushButton::clicked, this, &HistoryScrubber::on_liveBtnClicked);
+}
+
+// The slider unit is the second. While live, the handle waits at the present. Neither
+// changes the value seen by on_valueChanged
+void HistoryScrubber::refreshRange()
+{
+    const QSignalBlocker blocker(m_slider);
+    const qint64 first = m_history->firstTimestamp()/1000;
+    const qint64 last  = qMax(m_history->lastTimestamp(), QDateTime::currentMSecsSinceEpoch())/1000;
+
+    m_slider->setRange(0, int(last - first));
+
+    if (m_carousel->model() != m_historyModel)
+        m_slider->setValue(m_slider->maximum());
+}
+
+// Handle grabbed with the mouse
+void HistoryScrubber::on_sliderPressed()
+{
+    refreshRange();
+}
+
+// Click on the groove, page and arrow keys, wheel : emitted once the action moved the
+// position but before the value follows, the step is replayed from the refreshed value
+void HistoryScrubber::on_sliderAction(int action)
+{
+    if (action == QAbstractSlider::SliderMove)
+        return;
+
+    const int step = m_slider->sliderPosition() - m_slider->value();
+    refreshRange();
+
+    const QSignalBlocker blocker(m_slider);
+    m_slider->setSliderPosition(m_slider->value() + step);
+}
+
+void HistoryScrubber::on_valueChanged(int value)
+{
+    const qint64 timestamp = (m_history->firstTimestamp()/1000 + value)*1000 + 999;
+    int bcsPosition = 0;
+
+    if (!m_history->stateAt(timestamp, m_states, bcsPosition))
+        return;
+
+    m_historyModel->setStates(m_states, bcsPosition);
+
+    if (m_carousel->model() != m_historyModel)
+    {
+        m_carousel->setModel(m_historyModel);
+        m_liveBtn->setEnabled(true);
+    }
+
+    m_timeLabel->setText(QDateTime::fromMSecsSinceEpoch(timestamp).toString("hh:mm:ss"));
+}
+
+void HistoryScrubber::on_liveBtnClicked()
+{
+    m_carousel->setModel(m_liveModel);
+    m_liveBtn->setEnabled(false);
+    m_timeLabel->clear();
+}
@@ -0,0 +1,45 @@
+#ifndef HISTORYSCRUBBER_H
+#define HISTORYSCRUBBER_H
+
+#include <QWidget>
+#include <QSlider>
+#include <QLabel>
+#include <QPushButton>
+#include "BasicCarousel.h"
+#include "CarouselHistory.h"
+
+//---------------------------------------------------------------------------------------
+// class HistoryScrubber
+// Slider over the recorded history : moving it by any means (drag, click, keyboard) shows
+// the carousel at that instant, the Live button gives the live model back to the view.
+//---------------------------------------------------------------------------------------
+
+class HistoryScrubber : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit HistoryScrubber(CarouselHistory* history, BasicCarousel* carousel, QWidget *parent = nullptr);
+
+private slots:
+    void on_sliderPressed();
+    void on_sliderAction(int action);
+    void on_valueChanged(int value);
+    void on_liveBtnClicked();
+
+private:
+    void refreshRange();
+
+private:
+    CarouselHistory*  m_history;
+    BasicCarousel*    m_carousel;
+    CarouselModel*    m_liveModel;
+    CarouselModel*    m_historyModel;
+
+    QSlider*          m_slider;
+    QLabel*           m_timeLabel;
+    QPushButton*      m_liveBtn;
+
+    QVector<quint8>   m_states;
+};
+
+#endif // HISTORYSCRUBBER_H
@@ -0,0 +1,115 @@
+#include "IntervalSet.h"
+#include <climits>
+#include <iterator>
+
+void IntervalSet::insert(int first, int last)
+{
+    if (first > last)
+        return;
+
+    // Start from the interval touching first, if any. Adjacency is tested in 64 bits :
+    // first - 1 and last + 1 would overflow at the int limits
+    auto it = m_intervals.upper_bound(first);
+
+    if (it != m_intervals.begin() && qint64(std::prev(it)->second) + 1 >= first)
+        it = std::prev(it);
+
+    int mergedFirst = first;
+    int mergedLast = last;
+
+    while (it != m_intervals.end() && it->first <= qint64(last) + 1)
+    {
+        mergedFirst = qMin(mergedFirst, it->first);
+        mergedLast = qMax(mergedLast, it->second);
+        m_count -= it->second - it->first + 1;
+        it = m_intervals.erase(it);
+    }
+
+    m_intervals.emplace_hint(it, mergedFirst, mergedLast);
+    m_count += mergedLast - mergedFirst + 1;
+}
+
+void IntervalSet::remove(int first, int last)
+{
+    if (first > last)
+        return;
+
+    auto it = m_intervals.upper_bound(first);
+
+    if (it != m_intervals.begin() && std::prev(it)->second >= first)
+        it = std::prev(it);
+
+    while (it != m_intervals.end() && it->first <= last)
+    {
+        const int intervalFirst = it->first;
+        const int intervalLast = it->second;
+
+        m_count -= intervalLast - intervalFirst + 1;
+        it = m_intervals.erase(it);
+
+        // Parts outside [first, last] are kept
+        if (intervalFirst < first)
+        {
+            m_intervals.emplace_hint(it, intervalFirst, first - 1);
+            m_count += first - intervalFirst;
+        }
+
+        if (intervalLast > last)
+        {
+            m_intervals.emplace_hint(it, last + 1, intervalLast);
+            m_count += intervalLast - last;
+        }
+    }
+}
+
+bool IntervalSet::contains(int value) const
+{
+    auto it = m_intervals.upper_bound(value);
+
+    if (it == m_intervals.begin())
+        return false;
+
+    return std::prev(it)->second >= value;
+}
+
+QVector<IntervalSet::Interval> IntervalSet::intervals(int first, int last) const
+{
+    QVector<Interval> result;
+
+    auto it = m_intervals.upper_bound(first);
+
+    if (it != m_intervals.begin() && std::prev(it)->second >= first)
+        it = std::prev(it);
+
+    for (; it != m_intervals.end() && it->first <= last; ++it)
+        result.append(Interval(qMax(it->first, first), qMin(it->second, last)));
+
+    return result;
+}
+
+IntervalSet::Cursor::Cursor(const IntervalSet& set)
+    : m_set(set),
+      m_it(set.m_intervals.begin()),
+      m_last(INT_MIN)
+{
+}
+
+bool IntervalSet::Cursor::contains(int value)
+{
+    const auto end = m_set.m_intervals.end();
+
+    if (value < m_last)
+    {
+        m_it = m_set.m_intervals.upper_bound(value);
+
+        if (m_it != m_set.m_intervals.begin() && std::prev(m_it)->second >= value)
+            m_it = std::prev(m_it);
+    }
+
+    m_last = value;
+
+    while (m_it != end && m_it->second < value)
+        ++m_it;
+
+    return m_it != end && m_it->first <= value;
+}
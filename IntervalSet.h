@@ -0,0 +1,56 @@
+#ifndef INTERVALSET_H
+#define INTERVALSET_H
+
+#include <QVector>
+#include <QPair>
+#include <map>
+
+//---------------------------------------------------------------------------------------
+// class IntervalSet
+// Sorted set of disjoint inclusive integer intervals, adjacent intervals are merged.
+// Used for the disabled bucket ranges : ids never move with the rotation, so the
+// intervals stay valid whatever the carousel position.
+//---------------------------------------------------------------------------------------
+
+class IntervalSet
+{
+public:
+    typedef QPair<int, int> Interval;
+
+    IntervalSet() : m_count(0) {}
+
+    // O(log n) plus the number of intervals merged or split
+    void insert(int first, int last);
+    void remove(int first, int last);
+    void clear() { m_intervals.clear(); m_count = 0; }
+
+    bool contains(int value) const;
+    bool isEmpty() const { return m_intervals.empty(); }
+
+    // Number of values covered, not of intervals
+    int  count() const { return m_count; }
+    int  intervalCount() const { return int(m_intervals.size()); }
+
+    // Intervals intersecting [first, last], clipped to it
+    QVector<Interval> intervals(int first, int last) const;
+
+    // Membership checks for increasing values, amortised O(1) per value : rendering walks
+    // the ids in order, a backward jump (rotation wrap) costs one O(log n) seek
+    class Cursor
+    {
+    public:
+        explicit Cursor(const IntervalSet& set);
+        bool contains(int value);
+
+    private:
+        const IntervalSet&                m_set;
+        std::map<int, int>::const_iterator m_it;
+        int                               m_last;
+    };
+
+private:
+    std::map<int, int> m_intervals;     // first -> last
+    int                m_count;
+};
+
+#endif // INTERVALSET_H
@@ -0,0 +1,48 @@
+#include "LabelCache.h"
+
+static const char* const TRAY_PREFIX[LABEL_CACHE_PREFIXES] = { "LF", "LB", "UF", "UB" };
+
+QVector<QString> LabelCache::s_numbers;
+QVector<QString> LabelCache::s_trayLabels[LABEL_CACHE_PREFIXES];
+
+static int prefixIndex(ConveyorLevel level, ConveyorSide side)
+{
+    return 2*(level == ConveyorLevel::UPPER ? 1 : 0) + (side == ConveyorSide::BACK ? 1 : 0);
+}
+
+// Null until first asked, the vector only grows up to the largest id seen
+QString& LabelCache::entry(QVector<QString>& labels, int id)
+{
+    if (id >= labels.size())
+        labels.resize(id + 1);
+
+    return labels[id];
+}
+
+QString LabelCache::number(int id)
+{
+    if (id < 0 || id >= LABEL_CACHE_MAX_ID)
+        return QString::number(id);
+
+    QString& label = entry(s_numbers, id);
+
+    if (label.isNull())
+        label = QString::number(id);
+
+    return label;
+}
+
+QString LabelCache::trayLabel(ConveyorLevel level, ConveyorSide side, int id)
+{
+    const int prefix = prefixIndex(level, side);
+
+    if (level == ConveyorLevel::BOTH || id < 0 || id >= LABEL_CACHE_MAX_ID)
+        return QLatin1String(TRAY_PREFIX[prefix]) + QLatin1Char('\n') + QString::number(id);
+
+    QString& label = entry(s_trayLabels[prefix], id);
+
+    if (label.isNull())
+        label = QLatin1String(TRAY_PREFIX[prefix]) + QLatin1Char('\n') + number(id);
+
+    return label;
+}
@@ -0,0 +1,34 @@
+#ifndef LABELCACHE_H
+#define LABELCACHE_H
+
+#include <QString>
+#include <QVector>
+#include <Conveyor/Conveyor_T2K.h>
+
+//---------------------------------------------------------------------------------------
+// class LabelCache
+// Labels of the buckets and trays, formatted once per id and handed out as shared
+// copies of the cached string : relabelling a plate after a rotation only bumps a
+// reference count. GUI thread only.
+//---------------------------------------------------------------------------------------
+
+static const int LABEL_CACHE_MAX_ID   = 100000;   // larger ids are formatted on each call
+static const int LABEL_CACHE_PREFIXES = 4;        // LF, LB, UF, UB
+
+class LabelCache
+{
+public:
+    // "1234"
+    static QString number(int id);
+
+    // Output tray label, level and side prefix over the id : "UF\n12"
+    static QString trayLabel(ConveyorLevel level, ConveyorSide side, int id);
+
+private:
+    static QString& entry(QVector<QString>& labels, int id);
+
+    static QVector<QString> s_numbers;
+    static QVector<QString> s_trayLabels[LABEL_CACHE_PREFIXES];
+};
+
+#endif // LABELCACHE_H
@@ -1,9 +1,41 @@
 #include "MainWindow.h"
 #include "SingleLevelCarousel.h"
 #include "BasicCarousel.h"
+#include "CarouselHistory.h"
+#include "HistoryScrubber.h"
+#include "SharedBucketChannel.h"
+#include "SorterSimulator.h"
+#include "ConveyorModel.h"
+#include "OutputWall.h"
+#include "ContainerWall.h"
+#include "PaintProfilerOverlay.h"
+#include "TraceRecorder.h"
+#include "StallWatchdog.h"
+#include "WakeupMeter.h"
+#include "ConveyorSnapshot.h"
+#include "SynopticExporter.h"
+#include "TransitionRecorder.h"
+#include "TransitionReplayer.h"
+#include <QShortcut>
+#include <QResizeEvent>
+#include <QCoreApplication>
+
+// Value following an option on the command line, empty if absent
+static QString argumentValue(const QString& option, int offset = 1)
+{
+    const QStringList arguments = QCoreApplication::arguments();
+    const int index = arguments.indexOf(option);
+
+    return index > 0 && index + offset < arguments.size() ? arguments.at(index + offset) : QString();
+}
+
+static const qint64 EXPORT_STEP       = 1000;     // ms between two exported synoptics
+static const int    EXPORT_MAX_FRAMES = 600;      // the last ten minutes at most
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent)
+    : QMainWindow(parent),
+      m_carousel(nullptr),
+      m_scrubber(nullptr)
 {
 
     setGeometry(QRect(0, 0, 800, 500));
@@ -11,10 +43,156 @@ MainWindow::MainWindow(QWidget *parent)
     //SingleLevelCarousel* singleLevelCarousel = new SingleLevelCarousel(QRect(20, 20, 740, 182), 400, this);
 
     BasicCarousel* carousel = new BasicCarousel(QRect(20, 20, 740, 150), 60, this);
+    m_carousel = carousel;
+
+    ConveyorSnapshot* snapshot = new ConveyorSnapshot("conveyor.snapshot", this);
+
+    // Reproducible load instead of the demo rotation
+    if (QCoreApplication::arguments().contains("--simulate"))
+    {
+        SorterSimulatorConfig config;
+        config.bucketCount = 60;
+        config.outputsPerSide = 10;
+        config.levels = ConveyorLevel::UPPER;
+
+        SorterSimulator* simulator = new SorterSimulator(config, this);
+        carousel->setModel(simulator->model(ConveyorLevel::UPPER));
+
+        // The walls are views of the shared conveyor model, the simulator only writes to it
+        ConveyorModel* conveyor = new ConveyorModel(config.outputsPerSide, this);
+        connect(simulator, &SorterSimulator::outputStateChanged, conveyor,
+                QOverload<ConveyorLevel, ConveyorSide, int, OutputTrayState>::of(&ConveyorModel::setOutputState));
+        connect(simulator, &SorterSimulator::containerStateChanged, conveyor, &ConveyorModel::setContainerState);
+
+        OutputWall* outputWall = new OutputWall(conveyor, this);
+        outputWall->setGeometry(20, 240, 740, 160);
+        outputWall->setSelectionModel(new SelectionModel(outputWall->cellCount(), outputWall));
+
+        ContainerWall* containerWall = new ContainerWall(conveyor, this);
+        containerWall->setGeometry(20, 410, 740, 80);
+        containerWall->setSelectionModel(new SelectionModel(containerWall->cellCount(), containerWall));
+
+        snapshot->setConveyorModel(conveyor);
+
+        simulator->start();
+    }
+
+    // Last known state on the first frame, until the PLC has resent everything
+    snapshot->addCarousel(carousel->model());
+    snapshot->restore();
+    snapshot->start();
+
+    CarouselHistory* history = new CarouselHistory(carousel->model(), this);
+    m_scrubber = new HistoryScrubber(history, carousel, this);
+    m_scrubber->setGeometry(20, 190, 740, 30);
+
+    // Shift report : one synoptic per second of the recorded history, PNG (F10) or SVG (Shift+F10)
+    SynopticExporter* exporter = new SynopticExporter(history, this);
+
+    auto exportHistory = [history, exporter](SynopticExporter::Format format)
+    {
+        const qint64 last = history->lastTimestamp();
+        const qint64 first = qMax(history->firstTimestamp(), last - (EXPORT_MAX_FRAMES - 1)*EXPORT_STEP);
+
+        QVector<qint64> timestamps;
+        for (qint64 time = first; time <= last; time += EXPORT_STEP)
+            timestamps.append(time);
+
+        exporter->start(timestamps, "shift_report", format);
+    };
+
+    QShortcut* pngShortcut = new QShortcut(QKeySequence(Qt::Key_F10), this);
+    connect(pngShortcut, &QShortcut::activated, this, [exportHistory]() { exportHistory(SynopticExporter::PNG); });
 
+    QShortcut* svgShortcut = new QShortcut(QKeySequence(Qt::SHIFT + Qt::Key_F10), this);
+    connect(svgShortcut, &QShortcut::activated, this, [exportHistory]() { exportHistory(SynopticExporter::SVG); });
+
+    // Bucket states published by the gateway process (see --gateway-writer)
+    if (QCoreApplication::arguments().contains("--gateway"))
+    {
+        SharedBucketReader* gateway = new SharedBucketReader(carousel->model(), this);
+        gateway->attach();
+    }
+
+    // Every transition of the live model is logged (--record file.log)
+    const QString recordFile = argumentValue("--record");
+
+    if (!recordFile.isEmpty())
+    {
+        TransitionRecorder* recorder = new TransitionRecorder(this);
+
+        if (recorder->open(recordFile))
+            carousel->model()->setRecorder(recorder);
+    }
+
+    // A log is played back in the carousel instead of the live model (--replay file.log [speed]),
+    // the Live button of the scrubber gives the live model back
+    const QString replayFile = argumentValue("--replay");
+
+    if (!replayFile.isEmpty())
+    {
+        CarouselModel* replayModel = new CarouselModel(carousel->model()->bucketCount(), this);
+        TransitionReplayer* replayer = new TransitionReplayer(replayModel, this);
+
+        bool validSpeed = false;
+        const double speed = argumentValue("--replay", 2).toDouble(&validSpeed);
+
+        if (replayer->open(replayFile))
+        {
+            replayer->setSpeed(validSpeed ? speed : 1.0);
+            carousel->setModel(replayModel);
+            replayer->start();
+        }
+    }
+
+    // GUI stalls are reported to the given file (--stall-log file.log), following the model shown
+    const QString stallFile = argumentValue("--stall-log");
+
+    if (!stallFile.isEmpty())
+    {
+        StallWatchdog* watchdog = new StallWatchdog(carousel->model(), stallFile, this);
+        connect(carousel, &BasicCarousel::modelChanged, watchdog, &StallWatchdog::setModel);
+        watchdog->start(QThread::HighPriority);
+    }
+
+    // Idle cost on the panels : GUI wakeups per second with the line moving or stopped, recorded
+    // to the given file (--wakeups file.csv) or logged
+    if (QCoreApplication::arguments().contains("--wakeups"))
+    {
+        const QString wakeupFile = argumentValue("--wakeups");
+        new WakeupMeter(carousel->model(), wakeupFile.startsWith("--") ? QString() : wakeupFile, this);
+    }
+
+#ifdef CAROUSEL_TRACE
+    QShortcut* traceShortcut = new QShortcut(QKeySequence(Qt::Key_F11), this);
+    connect(traceShortcut, &QShortcut::activated, this, []() { TraceRecorder::exportChromeTrace("carousel_trace.json"); });
+#endif
+
+#ifdef CAROUSEL_PAINT_PROFILER
+    PaintProfilerOverlay* paintOverlay = new PaintProfilerOverlay(this);
+    paintOverlay->move(20, 240);
+
+    QShortcut* overlayShortcut = new QShortcut(QKeySequence(Qt::Key_F12), this);
+    connect(overlayShortcut, &QShortcut::activated, paintOverlay, &PaintProfilerOverlay::toggle);
+
+    QShortcut* dumpShortcut = new QShortcut(QKeySequence(Qt::CTRL + Qt::Key_F12), this);
+    connect(dumpShortcut, &QShortcut::activated, this, []() { PaintProfiler::dump("paint_profile.json"); });
+#endif
 }
 
 MainWindow::~MainWindow()
 {
 }
 
+// The carousel follows the window width, relaid out at each resize of a drag
+void MainWindow::resizeEvent(QResizeEvent *event)
+{
+    QMainWindow::resizeEvent(event);
+
+    if (!m_carousel)
+        return;
+
+    m_carousel->resize(qMax(width() - 60, 200), m_carousel->height());
+    m_scrubber->resize(m_carousel->width(), m_scrubber->height());
+}
+
@@ -3,6 +3,9 @@
 
 #include <QMainWindow>
 
+class BasicCarousel;
+class HistoryScrubber;
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -10,5 +13,12 @@ class MainWindow : public QMainWindow
 public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    BasicCarousel*   m_carousel;
+    HistoryScrubber* m_scrubber;
 };
 #endif // MAINWINDOW_H
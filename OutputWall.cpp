@@ -0,0 +1,77 @@
+#include "OutputWall.h"
+#include "PaintProfiler.h"
+#include "LabelCache.h"
+#include <QPainter>
+
+static const int   LABEL_MIN_WIDTH     = 24;      // cells narrower than this are painted without label
+static const QColor SELECTION_FILL     = QColor(0x5E, 0x96, 0xEB, 190);   // OutputTray selected colour, labels stay readable
+
+OutputWall::OutputWall(ConveyorModel* model, QWidget *parent)
+    : TrayWall(model->outputsPerSide(), parent),
+      m_model(model),
+      m_fontSize(8),
+      m_borderThickness(1)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setSelectionStyle(SELECTION_FILL, Qt::transparent, 0);
+
+    m_labels.resize(cellCount());
+
+    for (ConveyorLevel level : { ConveyorLevel::UPPER, ConveyorLevel::LOWER })
+    {
+        for (ConveyorSide side : { ConveyorSide::BACK, ConveyorSide::FRONT })
+        {
+            for (int i = 0; i < cellsPerLine(); i++)
+                m_labels[m_model->trayIndex(level, side, i)] = LabelCache::trayLabel(level, side, i);
+        }
+    }
+
+    updateAlarms(0, cellCount() - 1);
+
+    connect(m_model, &ConveyorModel::outputsChanged, this, [this](int first, int last)
+    {
+        updateAlarms(first, last);
+        updateRange(first, last);
+    });
+}
+
+// Outputs in a fault state blink, see StatePalette::isAlarm
+void OutputWall::updateAlarms(int first, int last)
+{
+    setAlarmedRange(first, last, [this](int index) { return m_model->isOutputAlarmed(index); });
+}
+
+void OutputWall::paintEvent(QPaintEvent *event)
+{
+    PAINT_PROFILE("OutputWall", event->rect());
+
+    QPainter painter(this);
+    painter.fillRect(event->rect(), palette().window());
+    painter.setPen(QPen(QColor("#000"), m_borderThickness, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin));
+    painter.setFont(QFont("Arial", m_fontSize, QFont::Normal));
+
+    // Only the cells intersecting the invalidated rectangle are visited
+    int firstLine, lastLine, firstCell, lastCell;
+
+    if (!cellsIn(event->rect(), firstLine, lastLine, firstCell, lastCell))
+        return;
+
+    const bool withLabels = width()/cellsPerLine() >= LABEL_MIN_WIDTH;
+
+    for (int line = firstLine; line <= lastLine; line++)
+    {
+        for (int i = line*cellsPerLine() + firstCell; i <= line*cellsPerLine() + lastCell; i++)
+        {
+            const QRect cell = cellRect(i);
+
+            painter.fillRect(cell, OutputTray::stateColor(m_model->outputState(i)));
+            painter.drawRect(cell.adjusted(0, 0, -m_borderThickness, -m_borderThickness));
+
+            if (withLabels)
+                painter.drawText(cell, Qt::AlignCenter, m_labels[i]);
+        }
+    }
+
+    paintAlarms(painter, event->rect());
+    paintSelection(painter, event->rect());
+}
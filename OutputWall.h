@@ -0,0 +1,38 @@
+#ifndef OUTPUTWALL_H
+#define OUTPUTWALL_H
+
+#include <QVector>
+#include <QPaintEvent>
+#include "TrayWall.h"
+
+//---------------------------------------------------------------------------------------
+// class OutputWall
+// All output trays of the sorter in one widget : the four lines (UB, UF, LB, LF) of the
+// ConveyorModel output column are painted as cells, without one widget per output. Only
+// the ranges notified by the model are repainted.
+//---------------------------------------------------------------------------------------
+
+class OutputWall : public TrayWall
+{
+    Q_OBJECT
+public:
+    // The model is not owned, several views may share it
+    explicit OutputWall(ConveyorModel* model, QWidget *parent = nullptr);
+
+    ConveyorModel* model() const { return m_model; }
+    int outputsPerSide() const { return cellsPerLine(); }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    void updateAlarms(int first, int last);
+
+private:
+    ConveyorModel*      m_model;
+    QVector<QString>    m_labels;           // built once, painted as is
+    int                 m_fontSize;
+    int                 m_borderThickness;
+};
+
+#endif // OUTPUTWALL_H
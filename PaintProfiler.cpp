@@ -0,0 +1,138 @@
+#include "PaintProfiler.h"
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QFile>
+#include <cstring>
+
+PaintProfiler::Slot PaintProfiler::s_slots[PAINT_PROFILER_CLASSES];
+
+double PaintProfileEntry::percentileUs(double percentile) const
+{
+    const quint64 target = quint64(count*percentile);
+    quint64 cumulated = 0;
+
+    for (int i = 0; i < PAINT_PROFILER_BINS; i++)
+    {
+        cumulated += bins[i];
+
+        if (cumulated > target)
+            return double(1 << (i + 1));    // upper bound of the bin
+    }
+
+    return double(1 << PAINT_PROFILER_BINS);
+}
+
+// Slots are claimed once per class name and never released, lookups take no lock
+PaintProfiler::Slot* PaintProfiler::slot(const char* name)
+{
+    for (int i = 0; i < PAINT_PROFILER_CLASSES; i++)
+    {
+        const char* slotName = s_slots[i].name.load(std::memory_order_acquire);
+
+        if (slotName == nullptr)
+        {
+            const char* expected = nullptr;
+
+            if (s_slots[i].name.compare_exchange_strong(expected, name, std::memory_order_acq_rel))
+                return &s_slots[i];
+
+            slotName = expected;
+        }
+
+        if (slotName == name || std::strcmp(slotName, name) == 0)
+            return &s_slots[i];
+    }
+
+    return nullptr;
+}
+
+void PaintProfiler::record(const char* name, qint64 durationNs, int area)
+{
+    Slot* entry = slot(name);
+
+    if (!entry)
+        return;
+
+    int bin = 0;
+    for (quint64 us = quint64(durationNs)/1000; us > 1 && bin < PAINT_PROFILER_BINS - 1; us >>= 1)
+        bin++;
+
+    entry->count.fetch_add(1, std::memory_order_relaxed);
+    entry->totalNs.fetch_add(quint64(durationNs), std::memory_order_relaxed);
+    entry->area.fetch_add(quint64(area), std::memory_order_relaxed);
+    entry->bins[bin].fetch_add(1, std::memory_order_relaxed);
+}
+
+QVector<PaintProfileEntry> PaintProfiler::entries()
+{
+    QVector<PaintProfileEntry> result;
+
+    for (int i = 0; i < PAINT_PROFILER_CLASSES; i++)
+    {
+        const char* name = s_slots[i].name.load(std::memory_order_acquire);
+
+        if (!name)
+            break;
+
+        PaintProfileEntry entry;
+        entry.name    = name;
+        entry.count   = s_slots[i].count.load(std::memory_order_relaxed);
+        entry.totalNs = s_slots[i].totalNs.load(std::memory_order_relaxed);
+        entry.area    = s_slots[i].area.load(std::memory_order_relaxed);
+
+        for (int bin = 0; bin < PAINT_PROFILER_BINS; bin++)
+            entry.bins[bin] = s_slots[i].bins[bin].load(std::memory_order_relaxed);
+
+        result.append(entry);
+    }
+
+    return result;
+}
+
+QJsonDocument PaintProfiler::toJson()
+{
+    QJsonArray classes;
+
+    for (const PaintProfileEntry& entry : entries())
+    {
+        QJsonArray bins;
+        for (int bin = 0; bin < PAINT_PROFILER_BINS; bin++)
+            bins.append(double(entry.bins[bin]));
+
+        QJsonObject object;
+        object["class"]     = QString(entry.name);
+        object["count"]     = double(entry.count);
+        object["totalUs"]   = entry.totalNs/1000.0;
+        object["averageUs"] = entry.averageUs();
+        object["p95Us"]     = entry.percentileUs(0.95);
+        object["area"]      = double(entry.area);
+        object["binsLog2Us"] = bins;
+
+        classes.append(object);
+    }
+
+    return QJsonDocument(classes);
+}
+
+bool PaintProfiler::dump(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    return file.write(toJson().toJson()) > 0;
+}
+
+void PaintProfiler::reset()
+{
+    for (int i = 0; i < PAINT_PROFILER_CLASSES; i++)
+    {
+        s_slots[i].count.store(0, std::memory_order_relaxed);
+        s_slots[i].totalNs.store(0, std::memory_order_relaxed);
+        s_slots[i].area.store(0, std::memory_order_relaxed);
+
+        for (int bin = 0; bin < PAINT_PROFILER_BINS; bin++)
+            s_slots[i].bins[bin].store(0, std::memory_order_relaxed);
+    }
+}
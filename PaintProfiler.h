@@ -0,0 +1,83 @@
+#ifndef PAINTPROFILER_H
+#define PAINTPROFILER_H
+
+#include <QRect>
+#include <QVector>
+#include <QJsonDocument>
+#include <QElapsedTimer>
+#include <atomic>
+
+//---------------------------------------------------------------------------------------
+// Paint-time instrumentation, compiled only with DEFINES += CAROUSEL_PAINT_PROFILER
+// PAINT_PROFILE(name, rect) at the top of a paintEvent records its duration, the paint
+// count and the invalidated area of the widget class into lock-free histograms.
+//---------------------------------------------------------------------------------------
+
+#ifdef CAROUSEL_PAINT_PROFILER
+#define PAINT_PROFILE(name, rect) PaintProfileScope paintProfileScope(name, rect)
+#else
+#define PAINT_PROFILE(name, rect) static_cast<void>(sizeof((rect)))   // unevaluated, the event still counts as used
+#endif
+
+static const int PAINT_PROFILER_CLASSES = 32;
+static const int PAINT_PROFILER_BINS    = 16;     // bin i : [2^i, 2^(i+1)) us
+
+struct PaintProfileEntry
+{
+    const char*     name;
+    quint64         count;
+    quint64         totalNs;
+    quint64         area;
+    quint64         bins[PAINT_PROFILER_BINS];
+
+    double          averageUs() const { return count ? totalNs/1000.0/count : 0.0; }
+    double          percentileUs(double percentile) const;
+};
+
+class PaintProfiler
+{
+public:
+    static void record(const char* name, qint64 durationNs, int area);
+
+    // Copy of the counters, safe to call from any thread
+    static QVector<PaintProfileEntry> entries();
+    static QJsonDocument toJson();
+    static bool dump(const QString& fileName);
+    static void reset();
+
+private:
+    struct Slot
+    {
+        std::atomic<const char*> name;
+        std::atomic<quint64>     count;
+        std::atomic<quint64>     totalNs;
+        std::atomic<quint64>     area;
+        std::atomic<quint64>     bins[PAINT_PROFILER_BINS];
+    };
+
+    static Slot* slot(const char* name);
+    static Slot  s_slots[PAINT_PROFILER_CLASSES];
+};
+
+class PaintProfileScope
+{
+public:
+    PaintProfileScope(const char* name, const QRect& rect)
+        : m_name(name),
+          m_area(rect.width()*rect.height())
+    {
+        m_timer.start();
+    }
+
+    ~PaintProfileScope()
+    {
+        PaintProfiler::record(m_name, m_timer.nsecsElapsed(), m_area);
+    }
+
+private:
+    const char*   m_name;
+    int           m_area;
+    QElapsedTimer m_timer;
+};
+
+#endif // PAINTPROFILER_H
@@ -0,0 +1,95 @@
+#include "PaintProfilerOverlay.h"
+#include <QPainter>
+
+static const int REFRESH_INTERVAL = 500;
+static const int LINE_HEIGHT      = 14;
+static const int OVERLAY_WIDTH    = 420;
+
+// Counters and histogram of the paints since the previous refresh
+static PaintProfileEntry sinceRefresh(const PaintProfileEntry& entry, const QVector<PaintProfileEntry>& previousEntries)
+{
+    PaintProfileEntry window = entry;
+
+    for (const PaintProfileEntry& previous : previousEntries)
+    {
+        if (previous.name == entry.name)
+        {
+            window.count -= previous.count;
+            window.totalNs -= previous.totalNs;
+            window.area -= previous.area;
+
+            for (int i = 0; i < PAINT_PROFILER_BINS; i++)
+                window.bins[i] -= previous.bins[i];
+            break;
+        }
+    }
+
+    return window;
+}
+
+PaintProfilerOverlay::PaintProfilerOverlay(QWidget *parent)
+    : QWidget{parent},
+      m_timer(new QTimer(this))
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    m_timer->setInterval(REFRESH_INTERVAL);
+    connect(m_timer, &QTimer::timeout, this, &PaintProfilerOverlay::on_timer);
+    hide();
+}
+
+void PaintProfilerOverlay::toggle()
+{
+    if (isVisible())
+    {
+        m_timer->stop();
+        hide();
+    }
+    else
+    {
+        m_previous = PaintProfiler::entries();
+        m_current = m_previous;
+        m_timer->start();
+        raise();
+        show();
+    }
+}
+
+void PaintProfilerOverlay::on_timer()
+{
+    m_previous = m_current;
+    m_current = PaintProfiler::entries();
+
+    resize(OVERLAY_WIDTH, (m_current.size() + 2)*LINE_HEIGHT);
+    update();
+}
+
+// Figures are per second, computed from the difference between two refreshes, the p95
+// included
+void PaintProfilerOverlay::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0, 0, 0, 180));
+    painter.setPen(QColor(255, 255, 255));
+    painter.setFont(QFont("Courier", 8));
+
+    const double seconds = REFRESH_INTERVAL/1000.0;
+    int y = LINE_HEIGHT;
+
+    painter.drawText(4, y, QString("%1 %2 %3 %4 %5")
+                     .arg("class", -22).arg("paint/s", 8).arg("avg us", 8).arg("p95 us", 8).arg("kpx/s", 8));
+
+    for (const PaintProfileEntry& entry : qAsConst(m_current))
+    {
+        const PaintProfileEntry window = sinceRefresh(entry, m_previous);
+
+        y += LINE_HEIGHT;
+        painter.drawText(4, y, QString("%1 %2 %3 %4 %5")
+                         .arg(QString(entry.name).left(22), -22)
+                         .arg(window.count/seconds, 8, 'f', 0)
+                         .arg(window.averageUs(), 8, 'f', 1)
+                         .arg(window.percentileUs(0.95), 8, 'f', 0)
+                         .arg(window.area/1000.0/seconds, 8, 'f', 0));
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef PAINTPROFILEROVERLAY_H
+#define PAINTPROFILEROVERLAY_H
+
+#include <QWidget>
+#include <QTimer>
+#include "PaintProfiler.h"
+
+//---------------------------------------------------------------------------------------
+// class PaintProfilerOverlay
+// HUD drawn over the main window with the paint statistics of each widget class.
+// Not instrumented itself, and only refreshed while visible.
+//---------------------------------------------------------------------------------------
+
+class PaintProfilerOverlay : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PaintProfilerOverlay(QWidget *parent);
+
+    void toggle();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private slots:
+    void on_timer();
+
+private:
+    QVector<PaintProfileEntry> m_previous;
+    QVector<PaintProfileEntry> m_current;
+    QTimer*                    m_timer;
+};
+
+#endif // PAINTPROFILEROVERLAY_H
@@ -1,4 +1,5 @@
 #include "RectangleWidget.h"
+#include "PaintProfiler.h"
 #include <QStyleOption>
 #include <QPainter>
 #include <QMouseEvent>
@@ -25,7 +26,7 @@ void RectangleWidget::setColor(QColor color, bool instantUpdate)
     if (isVisible() && instantUpdate) update();
 }
 
-void RectangleWidget::setText(QString text, bool instantUpdate)
+void RectangleWidget::setText(const QString& text, bool instantUpdate)
 {
     m_text = text;
     if (isVisible() && instantUpdate) update();
@@ -33,7 +34,7 @@ void RectangleWidget::setText(QString text, bool instantUpdate)
 
 void RectangleWidget::paintEvent( QPaintEvent* event )
 {
-    Q_UNUSED( event );
+    PAINT_PROFILE("RectangleWidget", event->rect());
 
     QPainter painter( this );
     painter.setRenderHint( QPainter::Antialiasing);
@@ -12,9 +12,10 @@ public:
     void setIsLast(bool isLast) {m_isLast = isLast;};
     void setSelected( bool selected ) {m_isSelected = selected;};
     void setColor(QColor color, bool instantUpdate = true);
-    void setText(QString text, bool instantUpdate = true);
+    void setText(const QString& text, bool instantUpdate = true);
     void setId(int id){m_id = id;};
     int id(){return m_id;};
+    QColor color() const {return m_color;};
 
 protected:
     void paintEvent( QPaintEvent* event ) override;
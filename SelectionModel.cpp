@@ -0,0 +1,198 @@
+#include "SelectionModel.h"
+#include <QtAlgorithms>
+
+SelectionModel::SelectionModel(int size, QObject *parent)
+    : QObject{parent},
+      m_size(qMax(size, 0)),
+      m_anchor(-1),
+      m_words((m_size + 63)/64, 0)
+{
+}
+
+int SelectionModel::count() const
+{
+    int count = 0;
+
+    for (quint64 word : m_words)
+        count += qPopulationCount(word);
+
+    return count;
+}
+
+int SelectionModel::nextSelected(int from) const
+{
+    if (from < 0)
+        from = 0;
+
+    if (from >= m_size)
+        return -1;
+
+    int w = from >> 6;
+    quint64 word = m_words[w] & (~quint64(0) << (from & 63));
+
+    while (word == 0)
+    {
+        if (++w == m_words.size())
+            return -1;
+
+        word = m_words[w];
+    }
+
+    return w*64 + qCountTrailingZeroBits(word);
+}
+
+// Whole words are written at once, only the two ends need a mask
+void SelectionModel::setBits(int first, int last, bool selected)
+{
+    const int firstWord = first >> 6;
+    const int lastWord  = last >> 6;
+    const quint64 firstMask = ~quint64(0) << (first & 63);
+    const quint64 lastMask  = ~quint64(0) >> (63 - (last & 63));
+    quint64* words = m_words.data();
+
+    if (firstWord == lastWord)
+    {
+        const quint64 mask = firstMask & lastMask;
+        words[firstWord] = selected ? words[firstWord] | mask : words[firstWord] & ~mask;
+        return;
+    }
+
+    words[firstWord] = selected ? words[firstWord] | firstMask : words[firstWord] & ~firstMask;
+
+    for (int w = firstWord + 1; w < lastWord; w++)
+        words[w] = selected ? ~quint64(0) : 0;
+
+    words[lastWord] = selected ? words[lastWord] | lastMask : words[lastWord] & ~lastMask;
+}
+
+void SelectionModel::setRange(int first, int last, bool selected)
+{
+    first = qMax(first, 0);
+    last  = qMin(last, m_size - 1);
+
+    if (first > last)
+        return;
+
+    setBits(first, last, selected);
+    emit selectionChanged(first, last);
+}
+
+void SelectionModel::toggle(int index)
+{
+    if (index < 0 || index >= m_size)
+        return;
+
+    m_words[index >> 6] ^= quint64(1) << (index & 63);
+    emit selectionChanged(index, index);
+}
+
+bool SelectionModel::selectedBounds(int& first, int& last) const
+{
+    first = nextSelected(0);
+
+    if (first < 0)
+        return false;
+
+    last = first;
+
+    for (int w = m_words.size() - 1; w >= 0; w--)
+    {
+        if (m_words[w])
+        {
+            last = w*64 + 63 - qCountLeadingZeroBits(m_words[w]);
+            break;
+        }
+    }
+
+    return true;
+}
+
+void SelectionModel::clear()
+{
+    int first, last;
+
+    if (!selectedBounds(first, last))
+        return;
+
+    m_words.fill(0);
+    emit selectionChanged(first, last);
+}
+
+// Selects [first, last] in bounds, replacing the current selection if asked
+void SelectionModel::selectRange(int first, int last, bool replace)
+{
+    int changedFirst = first;
+    int changedLast = last;
+    int oldFirst, oldLast;
+
+    if (replace && selectedBounds(oldFirst, oldLast))
+    {
+        m_words.fill(0);
+        changedFirst = qMin(changedFirst, oldFirst);
+        changedLast = qMax(changedLast, oldLast);
+    }
+
+    setBits(first, last, true);
+    emit selectionChanged(changedFirst, changedLast);
+}
+
+void SelectionModel::click(int index, Qt::KeyboardModifiers modifiers)
+{
+    if (index < 0 || index >= m_size)
+        return;
+
+    if ((modifiers & Qt::ShiftModifier) && m_anchor >= 0)
+    {
+        selectRange(qMin(m_anchor, index), qMax(m_anchor, index), !(modifiers & Qt::ControlModifier));
+        return;
+    }
+
+    if (modifiers & Qt::ControlModifier)
+        toggle(index);
+    else
+        selectRange(index, index, true);
+
+    m_anchor = index;
+}
+
+void SelectionModel::selectBlock(int firstLine, int lastLine, int firstCell, int lastCell, int cellsPerLine, bool extend)
+{
+    int oldFirst, oldLast;
+    const bool cleared = !extend && selectedBounds(oldFirst, oldLast);
+
+    if (cleared)
+        m_words.fill(0);
+
+    firstCell = qMax(firstCell, 0);
+    lastCell  = qMin(lastCell, cellsPerLine - 1);
+    firstLine = qMax(firstLine, 0);
+    lastLine  = qMin(lastLine, (m_size - 1)/qMax(cellsPerLine, 1));
+
+    if (firstCell > lastCell || firstLine > lastLine)
+    {
+        if (cleared)
+            emit selectionChanged(oldFirst, oldLast);
+        return;
+    }
+
+    for (int line = firstLine; line <= lastLine; line++)
+    {
+        const int first = line*cellsPerLine + firstCell;
+        const int last  = qMin(line*cellsPerLine + lastCell, m_size - 1);
+
+        if (first <= last)
+            setBits(first, last, true);
+    }
+
+    int changedFirst = firstLine*cellsPerLine + firstCell;
+    int changedLast  = qMin(lastLine*cellsPerLine + lastCell, m_size - 1);
+
+    // The cleared selection and the block are repainted together
+    if (cleared)
+    {
+        changedFirst = qMin(changedFirst, oldFirst);
+        changedLast  = qMax(changedLast, oldLast);
+    }
+
+    emit selectionChanged(changedFirst, changedLast);
+}
@@ -0,0 +1,59 @@
+#ifndef SELECTIONMODEL_H
+#define SELECTIONMODEL_H
+
+#include <QObject>
+#include <QVector>
+
+//---------------------------------------------------------------------------------------
+// class SelectionModel
+// Selected items of one view (buckets, outputs or containers) as a dynamic bitset.
+// Ranges are set and cleared a word at a time, the items themselves are never touched :
+// views read the bits back when painting and overlay the selection colour.
+//---------------------------------------------------------------------------------------
+
+class SelectionModel : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SelectionModel(int size, QObject *parent = nullptr);
+
+    int  size() const { return m_size; }
+    int  count() const;
+    int  anchor() const { return m_anchor; }
+
+    bool isSelected(int index) const { return (m_words[index >> 6] >> (index & 63)) & 1; }
+
+    // First selected index at or after from, -1 if none
+    int  nextSelected(int from) const;
+
+    void setRange(int first, int last, bool selected);
+    void select(int index) { setRange(index, index, true); }
+    void deselect(int index) { setRange(index, index, false); }
+    void toggle(int index);
+    void clear();
+
+    // Usual list semantics : plain click selects one item, Ctrl toggles, Shift extends
+    // from the anchor
+    void click(int index, Qt::KeyboardModifiers modifiers);
+
+    // Rectangle of a grid stored line after line (rubber band), added to the selection
+    // when extend is true
+    void selectBlock(int firstLine, int lastLine, int firstCell, int lastCell, int cellsPerLine, bool extend);
+
+signals:
+    // Inclusive range of indices whose selection may have changed, once per operation :
+    // a replaced selection is notified with the union of the old and new ranges
+    void selectionChanged(int first, int last);
+
+private:
+    void setBits(int first, int last, bool selected);
+    bool selectedBounds(int& first, int& last) const;
+    void selectRange(int first, int last, bool replace);
+
+private:
+    int              m_size;
+    int              m_anchor;
+    QVector<quint64> m_words;
+};
+
+#endif // SELECTIONMODEL_H
@@ -1,4 +1,6 @@
 #include "SemicircleWidgetAlt.h"
+#include "PaintProfiler.h"
+#include "TraceRecorder.h"
 
 //---------------------------------------------------------------------------------------
 // class Semicircle Widget
@@ -20,7 +22,8 @@ SemicircleWidgetAlt::SemicircleWidgetAlt(QWidget *parent, int distBetweenCircles
 
 void SemicircleWidgetAlt::paintEvent(QPaintEvent *event)
 {
-    Q_UNUSED(event);
+    PAINT_PROFILE("SemicircleWidgetAlt", event->rect());
+    TRACE_SCOPE("SemicircleWidgetAlt::paintEvent");
 
     QPainter painter( this );
     painter.setRenderHint(QPainter::Antialiasing);
@@ -0,0 +1,260 @@
+#include "SharedBucketChannel.h"
+#include <QDebug>
+#include <cstring>
+#include <atomic>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+static const int FRAME_INTERVAL     = 16;
+static const int IDLE_INTERVAL      = 512;     // ms, worst latency of the first publication after a pause
+static const int MAX_READ_ATTEMPTS  = 3;
+
+// The slot starts on a cache line
+static size_t slotSize(int bucketCount) { return (size_t(bucketCount) + 63) & ~size_t(63); }
+static size_t slotOffset() { return (sizeof(SharedBucketHeader) + 63) & ~size_t(63); }
+
+qint64 sharedBucketClock()
+{
+#ifdef Q_OS_UNIX
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return qint64(now.tv_sec)*1000000000 + now.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+//---------------------------------------------------------------------------------------
+// class SharedBucketWriter
+//---------------------------------------------------------------------------------------
+
+SharedBucketWriter::SharedBucketWriter()
+    : m_header(nullptr),
+      m_slot(nullptr),
+      m_size(0)
+{
+}
+
+SharedBucketWriter::~SharedBucketWriter()
+{
+    close();
+}
+
+bool SharedBucketWriter::create(const char* name, int bucketCount)
+{
+#ifdef Q_OS_UNIX
+    close();
+
+    m_size = slotOffset() + slotSize(bucketCount);
+
+    int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+
+    if (fd < 0)
+    {
+        qWarning() << "Cannot create shared bucket segment" << name << strerror(errno);
+        return false;
+    }
+
+    if (ftruncate(fd, off_t(m_size)) != 0)
+    {
+        qWarning() << "Cannot size shared bucket segment" << strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        qWarning() << "Cannot map shared bucket segment" << strerror(errno);
+        return false;
+    }
+
+    m_name = name;
+    m_header = static_cast<SharedBucketHeader*>(map);
+    m_slot = static_cast<quint8*>(map) + slotOffset();
+
+    std::memset(map, 0, m_size);
+    m_header->bucketCount = quint32(bucketCount);
+    m_header->sequence.store(0, std::memory_order_relaxed);
+    m_header->magic = SHARED_BUCKET_MAGIC;
+
+    return true;
+#else
+    Q_UNUSED(name);
+    Q_UNUSED(bucketCount);
+    return false;
+#endif
+}
+
+void SharedBucketWriter::close()
+{
+#ifdef Q_OS_UNIX
+    if (!m_header)
+        return;
+
+    munmap(m_header, m_size);
+    shm_unlink(m_name.constData());
+    m_header = nullptr;
+#endif
+}
+
+void SharedBucketWriter::publish(const quint8* states, int bcsPosition)
+{
+    if (!m_header)
+        return;
+
+    const quint32 sequence = m_header->sequence.load(std::memory_order_relaxed);
+
+    // Odd while writing : a reader copying the slot meanwhile discards its copy. The fence
+    // keeps the slot writes after the odd sequence
+    m_header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(m_slot, states, m_header->bucketCount);
+    m_header->bcsPosition.store(bcsPosition, std::memory_order_relaxed);
+    m_header->writeTime.store(sharedBucketClock(), std::memory_order_relaxed);
+
+    m_header->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------------
+// class SharedBucketReader
+//---------------------------------------------------------------------------------------
+
+SharedBucketReader::SharedBucketReader(CarouselModel* model, QObject *parent)
+    : QObject{parent},
+      m_model(model),
+      m_header(nullptr),
+      m_slot(nullptr),
+      m_size(0),
+      m_lastSequence(0),
+      m_lastLatency(0),
+      m_maxLatency(0),
+      m_scheduler(new FrameScheduler(FRAME_INTERVAL, IDLE_INTERVAL, this))
+{
+    connect(m_scheduler, &FrameScheduler::frame, this, &SharedBucketReader::on_frame);
+}
+
+SharedBucketReader::~SharedBucketReader()
+{
+    detach();
+}
+
+bool SharedBucketReader::attach(const char* name)
+{
+#ifdef Q_OS_UNIX
+    detach();
+
+    int fd = shm_open(name, O_RDONLY, 0);
+
+    if (fd < 0)
+    {
+        qWarning() << "Cannot open shared bucket segment" << name << strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < slotOffset())
+    {
+        ::close(fd);
+        return false;
+    }
+
+    m_size = size_t(info.st_size);
+    void* map = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        qWarning() << "Cannot map shared bucket segment" << strerror(errno);
+        return false;
+    }
+
+    m_header = static_cast<const SharedBucketHeader*>(map);
+
+    if (m_header->magic != SHARED_BUCKET_MAGIC ||
+        m_size < slotOffset() + slotSize(int(m_header->bucketCount)))
+    {
+        qWarning() << "Invalid shared bucket segment" << name;
+        detach();
+        return false;
+    }
+
+    m_slot = static_cast<const quint8*>(map) + slotOffset();
+    m_copy.resize(int(m_header->bucketCount));
+    m_lastSequence = 0;
+    m_maxLatency = 0;
+
+    m_scheduler->start();
+    return true;
+#else
+    Q_UNUSED(name);
+    return false;
+#endif
+}
+
+void SharedBucketReader::detach()
+{
+    m_scheduler->stop();
+
+#ifdef Q_OS_UNIX
+    if (m_header)
+        munmap(const_cast<SharedBucketHeader*>(m_header), m_size);
+#endif
+
+    m_header = nullptr;
+}
+
+void SharedBucketReader::on_frame()
+{
+    poll();
+}
+
+bool SharedBucketReader::poll()
+{
+    if (!m_header)
+        return false;
+
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++)
+    {
+        const quint32 sequence = m_header->sequence.load(std::memory_order_acquire);
+
+        if (sequence == m_lastSequence)
+            return false;
+
+        m_scheduler->markBusy();
+
+        // Being written : the next attempt or frame takes it
+        if (sequence & 1)
+            continue;
+
+        // Copied first, see the class comment
+        std::memcpy(m_copy.data(), m_slot, size_t(m_copy.size()));
+        const int    bcsPosition = m_header->bcsPosition.load(std::memory_order_relaxed);
+        const qint64 writeTime   = m_header->writeTime.load(std::memory_order_relaxed);
+
+        // A publication started during the copy : it may be torn, nothing reaches the model
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (m_header->sequence.load(std::memory_order_relaxed) != sequence)
+            continue;
+
+        m_lastSequence = sequence;
+        m_model->applyStates(0, m_copy.constData(), m_copy.size(), bcsPosition);
+
+        m_lastLatency = (sharedBucketClock() - writeTime)/1000;
+        m_maxLatency = qMax(m_maxLatency, m_lastLatency);
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,101 @@
+#ifndef SHAREDBUCKETCHANNEL_H
+#define SHAREDBUCKETCHANNEL_H
+
+#include <QObject>
+#include <QVector>
+#include <atomic>
+#include "CarouselModel.h"
+#include "FrameScheduler.h"
+
+//---------------------------------------------------------------------------------------
+// Shared-memory bucket channel between the PLC gateway process and the HMI.
+// The POSIX segment holds a header followed by the packed state slot, guarded by a
+// seqlock : the sequence is odd while the gateway writes, and a reader keeps its copy
+// only if the sequence is even and unchanged once the copy is done.
+//---------------------------------------------------------------------------------------
+
+struct SharedBucketHeader
+{
+    quint32              magic;
+    quint32              bucketCount;
+    std::atomic<quint32> sequence;          // odd while the slot is written
+    std::atomic<qint32>  bcsPosition;
+    std::atomic<qint64>  writeTime;         // CLOCK_MONOTONIC ns, for the latency measure
+};
+
+static const quint32 SHARED_BUCKET_MAGIC = 0x32434253;     // "SBC2", single slot seqlock
+static const char    SHARED_BUCKET_DEFAULT_NAME[] = "/carousel_buckets";
+
+qint64 sharedBucketClock();
+
+//---------------------------------------------------------------------------------------
+// class SharedBucketWriter - gateway side
+//---------------------------------------------------------------------------------------
+
+class SharedBucketWriter
+{
+public:
+    SharedBucketWriter();
+    ~SharedBucketWriter();
+
+    bool create(const char* name, int bucketCount);
+    void close();
+
+    void publish(const quint8* states, int bcsPosition);
+
+private:
+    QByteArray          m_name;
+    SharedBucketHeader* m_header;
+    quint8*             m_slot;
+    size_t              m_size;
+};
+
+//---------------------------------------------------------------------------------------
+// class SharedBucketReader - HMI side
+// Maps the segment read-only, copies the published slot once per frame and diffs the
+// copy into the model when it is consistent. The segment can only be polled : while the
+// gateway publishes nothing the polling slows down, doubling the interval at each empty
+// frame up to half a second.
+// The copy is the one departure from zero-copy : diffing straight from the segment could
+// feed a torn publication into the model, which has no way to take it back, while
+// validating a slot by its sequence requires reading it first. It is one memcpy of a
+// cache-hot slot (2 kB for 2000 buckets), small against the diff that follows, see the
+// gatewayLatency benchmark.
+//---------------------------------------------------------------------------------------
+
+class SharedBucketReader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SharedBucketReader(CarouselModel* model, QObject *parent = nullptr);
+    ~SharedBucketReader();
+
+    bool attach(const char* name = SHARED_BUCKET_DEFAULT_NAME);
+    void detach();
+
+    // Gateway write to model update, in microseconds, the worst since attach
+    qint64 lastLatency() const { return m_lastLatency; }
+    qint64 maxLatency() const { return m_maxLatency; }
+
+    // Takes the last publication into the model, if new and consistent. Called at each
+    // frame of the scheduler, returns true if the model was updated
+    bool   poll();
+
+private slots:
+    void on_frame();
+
+private:
+    CarouselModel*            m_model;
+    const SharedBucketHeader* m_header;
+    const quint8*             m_slot;
+    size_t                    m_size;
+    quint32                   m_lastSequence;
+    QVector<quint8>           m_copy;             // last copy of the slot, diffed once consistent
+
+    qint64                    m_lastLatency;
+    qint64                    m_maxLatency;
+
+    FrameScheduler*           m_scheduler;
+};
+
+#endif // SHAREDBUCKETCHANNEL_H
@@ -1,21 +1,52 @@
 #include "SingleLevelCarousel.h"
 #include "SemicircleWidgetAlt.h"
+#include <QMouseEvent>
+#include <QResizeEvent>
+#include <QPainter>
 
 static const int CAROUSEL_LINE_HEIGHT              = 40;
 static const int CAROUSEL_CURVES_WIDTH             = 80;
 static const int CAROUSEL_LINES_SPACING            = 100;
 static const int SYNOPTIC_BUTTON_WIDTH             = 40;
+static const int ZOOM_HANDLE_WIDTH                 = 55;
+static const int ZOOM_WINDOW_MARGIN                = 20;
+static const int RELAYOUT_DELAY                    = 100;   // ms without a resize before the children are laid out
 
 SingleLevelCarousel::SingleLevelCarousel(QRect geoRect, int nbBuckets, QWidget *parent)
-    : QWidget(parent)
+    : QWidget(parent),
+      m_synoptic(nullptr),
+      m_zoomLine(nullptr),
+      m_relayoutTimer(new QTimer(this))
 {
     this->setGeometry(geoRect);
 
+    m_relayoutTimer->setSingleShot(true);
+    m_relayoutTimer->setInterval(RELAYOUT_DELAY);
+    connect(m_relayoutTimer, &QTimer::timeout, this, [this]() { settleResize(); });
+
     NB_BUCKETS = nbBuckets;
 
+    m_model = new CarouselModel(NB_BUCKETS, this);
+
+    for (int i = 0; i < NB_BUCKETS; i++)
+        m_model->setState(i, (i%2) ? BucketState::FAILURE : BucketState::SORTED);
+
     m_synopticAvailableWidth =  width() - SYNOPTIC_BUTTON_WIDTH;
 
+    m_clickDispatcher = new BucketClickDispatcher([](QWidget* cell) { return static_cast<RectangleWidget*>(cell)->id(); }, this);
+    connect(m_clickDispatcher, &BucketClickDispatcher::bucketClicked, this, &SingleLevelCarousel::on_bucketClicked);
+
     m_synoptic = createSynopticView();
+
+    // The zoom window sits in the masked interior of the carousel, between the two lines
+    m_zoomWindow = new ZoomWindowWidget(m_model, this);
+    m_zoomWindow->setGeometry(CAROUSEL_CURVES_WIDTH, CAROUSEL_LINE_HEIGHT + ZOOM_WINDOW_MARGIN,
+                              m_synopticAvailableWidth - 2*CAROUSEL_CURVES_WIDTH,
+                              CAROUSEL_LINES_SPACING - 2*ZOOM_WINDOW_MARGIN);
+    m_zoomWindow->raise();
+
+    // Synoptic and zoom window are both refreshed by the same model notification
+    connect(m_model, &CarouselModel::bucketsChanged, this, &SingleLevelCarousel::on_bucketsChanged);
 }
 
 
@@ -68,8 +99,6 @@ QWidget* SingleLevelCarousel::createSynopticContainer()
 {
    int upperBackNr, upperFrontNr, maxBucketsPerLine;
 
-   m_bucketsAvailableWidth =  2*m_synopticAvailableWidth - 2*CAROUSEL_CURVES_WIDTH;
-
    upperFrontNr = NB_BUCKETS/2;
 
    if (NB_BUCKETS % 2 == 0)
@@ -79,19 +108,20 @@ QWidget* SingleLevelCarousel::createSynopticContainer()
 
    maxBucketsPerLine = upperBackNr;
 
+   m_bucketsAvailableWidth =  2*m_synopticAvailableWidth - 2*CAROUSEL_CURVES_WIDTH;
    m_bucketWidth = m_bucketsAvailableWidth/maxBucketsPerLine;
 
    // Create the two lines
    // IMPORTANT : The creation order is important
-   m_frontLine = createCarouselLine( upperFrontNr );
-   m_backLine = createCarouselLine( upperBackNr );
+   m_frontLine = createCarouselLine( upperFrontNr, ConveyorSide::FRONT );
+   m_backLine = createCarouselLine( upperBackNr, ConveyorSide::BACK );
 
    QWidget* synopticContainer = new QWidget(this);
    synopticContainer->setFixedSize(2*m_synopticAvailableWidth, height());
 
-   QWidget* level = createLevelContainer();
-   level->setParent(synopticContainer);
-   level->move(0,0);
+   m_levelContainer = createLevelContainer();
+   m_levelContainer->setParent(synopticContainer);
+   m_levelContainer->move(0,0);
 
    m_zoomHandle = createZoomHandle();
    m_zoomHandle->setParent(synopticContainer);
@@ -101,32 +131,20 @@ QWidget* SingleLevelCarousel::createSynopticContainer()
 
 
 // Creates a line composed of buckets
-QWidget *SingleLevelCarousel::createCarouselLine(int nb_buckets)
+QWidget *SingleLevelCarousel::createCarouselLine(int nb_buckets, ConveyorSide side)
 {
-    int bucketWidth;
-    m_lineWidth = 0;
-    int nb_oversizeBuckets =  m_bucketsAvailableWidth - m_bucketWidth*nb_buckets;
-
     QWidget* conveyorLineWidget = new QWidget(this);
     conveyorLineWidget->setContentsMargins(0,0,0,0);
     conveyorLineWidget->setLayout(new QHBoxLayout());
     conveyorLineWidget->layout()->setSpacing(0);
     conveyorLineWidget->layout()->setMargin(0);
 
+    QVector<QWidget*> cells;
+
     for (int i=0; i < nb_buckets; i++)
     {
         RectangleWidget* bucket = new RectangleWidget(this);
 
-        nb_oversizeBuckets--;
-        if (nb_oversizeBuckets > 0 || nb_oversizeBuckets > nb_buckets)
-            bucketWidth = m_bucketWidth + 1;
-        else
-            bucketWidth = m_bucketWidth;
-
-        bucket->setFixedHeight(CAROUSEL_LINE_HEIGHT);
-        bucket->setFixedWidth(bucketWidth);
-        m_lineWidth += bucketWidth;
-
         if(i == nb_buckets-1)
         {
             bucket->setIsLast(true);
@@ -135,24 +153,45 @@ QWidget *SingleLevelCarousel::createCarouselLine(int nb_buckets)
         else
              bucket->setStyleSheet("border:1px solid black; border-right:0px;");
 
-        if (i%2)
-            bucket->setColor(QColor(255,70,80,255));
-        else
-           bucket->setColor(QColor(122, 163, 39, 255));
-
-        bucket->setId(i);
+        bucket->setId(m_buckets.size());
+        bucket->setColor(BucketPlate::stateColor(m_model->state(bucket->id())));
 
         conveyorLineWidget->layout()->addWidget(bucket);
 
-        connect(bucket, &RectangleWidget::click, this, &SingleLevelCarousel::on_bucketClick);
-
         m_buckets.append(bucket);
+        cells.append(bucket);
     }
 
+    // Clicks are resolved by the line, no connection per bucket
+    m_clickDispatcher->addLine(conveyorLineWidget, cells, side, ConveyorLevel::UPPER);
+
+    sizeLine(m_buckets.mid(m_buckets.size() - nb_buckets));
+
     return conveyorLineWidget;
 }
 
 
+// Bucket widths of one line for the current m_bucketWidth, sets m_lineWidth
+void SingleLevelCarousel::sizeLine(const QVector<RectangleWidget*>& buckets)
+{
+    int bucketWidth;
+    m_lineWidth = 0;
+    int nb_oversizeBuckets =  m_bucketsAvailableWidth - m_bucketWidth*buckets.size();
+
+    for (RectangleWidget* bucket : buckets)
+    {
+        nb_oversizeBuckets--;
+        if (nb_oversizeBuckets > 0 || nb_oversizeBuckets > buckets.size())
+            bucketWidth = m_bucketWidth + 1;
+        else
+            bucketWidth = m_bucketWidth;
+
+        bucket->setFixedSize(bucketWidth, CAROUSEL_LINE_HEIGHT);
+        m_lineWidth += bucketWidth;
+    }
+}
+
+
 // Creates 2 curbed widgets and place them at the end of the 2 lines and a space in the middle
 QWidget* SingleLevelCarousel::createLevelContainer()
 {
@@ -168,20 +207,20 @@ QWidget* SingleLevelCarousel::createLevelContainer()
     levelWidgetLayout->setSpacing(0);
 
     // Creates te container for the 2 lines and a middle separator
-    QWidget* linesContainer = new QWidget(levelWidget);
-    linesContainer->setFixedSize( m_lineWidth , CAROUSEL_LINE_HEIGHT*2 + CAROUSEL_LINES_SPACING);
+    m_linesContainer = new QWidget(levelWidget);
+    m_linesContainer->setFixedSize( m_lineWidth , CAROUSEL_LINE_HEIGHT*2 + CAROUSEL_LINES_SPACING);
 
-    QWidget* linesSeparator = new QWidget(linesContainer);
-    linesSeparator->setFixedSize( m_lineWidth , CAROUSEL_LINES_SPACING);
-    linesSeparator->setAttribute(Qt::WA_TransparentForMouseEvents);
-    linesSeparator->setAttribute(Qt::WA_TranslucentBackground);
+    m_linesSeparator = new QWidget(m_linesContainer);
+    m_linesSeparator->setFixedSize( m_lineWidth , CAROUSEL_LINES_SPACING);
+    m_linesSeparator->setAttribute(Qt::WA_TransparentForMouseEvents);
+    m_linesSeparator->setAttribute(Qt::WA_TranslucentBackground);
 
-    linesContainer->setLayout(new QVBoxLayout());
-    linesContainer->layout()->setMargin(0);
-    linesContainer->layout()->setSpacing(0);
-    linesContainer->layout()->addWidget(m_backLine);
-    linesContainer->layout()->addWidget(linesSeparator);
-    linesContainer->layout()->addWidget(m_frontLine);
+    m_linesContainer->setLayout(new QVBoxLayout());
+    m_linesContainer->layout()->setMargin(0);
+    m_linesContainer->layout()->setSpacing(0);
+    m_linesContainer->layout()->addWidget(m_backLine);
+    m_linesContainer->layout()->addWidget(m_linesSeparator);
+    m_linesContainer->layout()->addWidget(m_frontLine);
 
     SemicircleWidgetAlt* leftCurves = new SemicircleWidgetAlt(levelWidget, CAROUSEL_LINE_HEIGHT-2, true);
     leftCurves->setFixedSize(CAROUSEL_CURVES_WIDTH , CAROUSEL_LINE_HEIGHT*2 + CAROUSEL_LINES_SPACING);
@@ -193,36 +232,228 @@ QWidget* SingleLevelCarousel::createLevelContainer()
 
     levelWidgetLayout->addWidget(leftCurves);
     levelWidgetLayout->addWidget(rightCurves);
-    levelWidgetLayout->insertWidget(1,linesContainer);
-    linesContainer->raise();
+    levelWidgetLayout->insertWidget(1,m_linesContainer);
+    m_linesContainer->raise();
 
+    // Always present so a relayout can resize it, an empty spacer takes no room
     int spacingWidth = levelWidgetWidth - m_lineWidth - 2*CAROUSEL_CURVES_WIDTH;
 
-    if ( spacingWidth > 0 )
-        levelWidgetLayout->insertSpacing(0, spacingWidth);
+    m_levelSpacer = new QSpacerItem(qMax(spacingWidth, 0), 0, QSizePolicy::Fixed, QSizePolicy::Minimum);
+    levelWidgetLayout->insertSpacerItem(0, m_levelSpacer);
+
+    levelWidget->setMask(levelMask(levelWidgetWidth));
 
-    // Mask the interior
+    return levelWidget;
+}
+
+
+// Masks the interior between the two lines
+QRegion SingleLevelCarousel::levelMask(int levelWidgetWidth) const
+{
     QRegion levelWidgetRegion = QRegion(QRect(0, 0, levelWidgetWidth , height()));
     QRegion regionToMask      = QRegion(QRect(CAROUSEL_CURVES_WIDTH,CAROUSEL_LINE_HEIGHT,
                                               levelWidgetWidth - 2*CAROUSEL_CURVES_WIDTH , CAROUSEL_LINES_SPACING));
-    QRegion levelWidgetMaskRegion = levelWidgetRegion.subtracted(regionToMask);
-    levelWidget->setMask(levelWidgetMaskRegion);
+    return levelWidgetRegion.subtracted(regionToMask);
+}
 
-    return levelWidget;
+
+// Resizes the existing children to the new width, nothing is created or connected again
+void SingleLevelCarousel::relayout()
+{
+    m_synopticAvailableWidth =  width() - SYNOPTIC_BUTTON_WIDTH;
+    m_bucketsAvailableWidth =  2*m_synopticAvailableWidth - 2*CAROUSEL_CURVES_WIDTH;
+    m_bucketWidth = m_bucketsAvailableWidth/((NB_BUCKETS + 1)/2);
+
+    // The back line is sized last, as at creation : it gives m_lineWidth
+    sizeLine(m_buckets.mid(0, NB_BUCKETS/2));
+    sizeLine(m_buckets.mid(NB_BUCKETS/2));
+
+    const int levelWidgetWidth = 2 * m_synopticAvailableWidth - 1;
+
+    m_synoptic->setFixedSize(m_synopticAvailableWidth + SYNOPTIC_BUTTON_WIDTH, height());
+    m_synopticRightBtn->setFixedSize(SYNOPTIC_BUTTON_WIDTH, height());
+    m_synopticLeftBtn->setFixedSize(SYNOPTIC_BUTTON_WIDTH, height());
+    m_scrollArea->setFixedSize(m_synopticAvailableWidth, height());
+    m_synopticContainer->setFixedSize(2*m_synopticAvailableWidth, height());
+
+    m_linesContainer->setFixedSize( m_lineWidth , CAROUSEL_LINE_HEIGHT*2 + CAROUSEL_LINES_SPACING);
+    m_linesSeparator->setFixedSize( m_lineWidth , CAROUSEL_LINES_SPACING);
+    m_levelSpacer->changeSize(qMax(levelWidgetWidth - m_lineWidth - 2*CAROUSEL_CURVES_WIDTH, 0), 0,
+                              QSizePolicy::Fixed, QSizePolicy::Minimum);
+    m_levelContainer->setMaximumSize(levelWidgetWidth, 2 * CAROUSEL_LINE_HEIGHT + CAROUSEL_LINES_SPACING);
+    m_levelContainer->setMask(levelMask(levelWidgetWidth));
+
+    // The handle position is derived from the line geometries : lay them out now
+    m_backLine->layout()->activate();
+    m_frontLine->layout()->activate();
+    m_linesContainer->layout()->activate();
+    m_levelContainer->layout()->invalidate();
+    m_levelContainer->layout()->activate();
+    m_levelContainer->adjustSize();
+
+    m_zoomWindow->setGeometry(CAROUSEL_CURVES_WIDTH, CAROUSEL_LINE_HEIGHT + ZOOM_WINDOW_MARGIN,
+                              m_synopticAvailableWidth - 2*CAROUSEL_CURVES_WIDTH,
+                              CAROUSEL_LINES_SPACING - 2*ZOOM_WINDOW_MARGIN);
+
+    // Keeps the half of the synoptic which was shown
+    if (m_synopticLeftBtn->isVisible())
+        m_scrollArea->horizontalScrollBar()->setValue(m_synopticAvailableWidth);
+
+    if (m_zoomLine != nullptr)
+        moveZoomHandle(m_zoomHandle->pos());
+}
+
+
+// Debounced as BasicCarousel : the synoptic and the zoom window are hidden behind a
+// stretched picture of the synoptic until no resize came for RELAYOUT_DELAY
+void SingleLevelCarousel::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+
+    if (!m_synoptic || !event->oldSize().isValid())
+        return;
+
+    if (!isVisible())
+    {
+        relayout();
+        return;
+    }
+
+    if (m_resizePreview.isNull())
+    {
+        const QRectF geometry = m_synoptic->geometry();
+        const QSizeF oldSize = event->oldSize();
+
+        m_resizePreview = m_synoptic->grab();
+        m_previewGeometry = QRectF(geometry.x()/oldSize.width(), geometry.y()/oldSize.height(),
+                                   geometry.width()/oldSize.width(), geometry.height()/oldSize.height());
+        m_synoptic->hide();
+        m_zoomWindow->hide();
+    }
+
+    m_relayoutTimer->start();
+    update();
+}
+
+
+void SingleLevelCarousel::settleResize()
+{
+    relayout();
+
+    m_resizePreview = QPixmap();
+    m_synoptic->show();
+    m_zoomWindow->show();
+    update();
+}
+
+
+void SingleLevelCarousel::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+
+    if (m_resizePreview.isNull())
+        return;
+
+    const QRectF target(m_previewGeometry.x()*width(), m_previewGeometry.y()*height(),
+                        m_previewGeometry.width()*width(), m_previewGeometry.height()*height());
+
+    QPainter painter(this);
+    painter.drawPixmap(target, m_resizePreview, m_resizePreview.rect());
 }
 
 
 QWidget *SingleLevelCarousel::createZoomHandle()
 {
     QWidget* widget = new QWidget(this);
-    widget->setAttribute(Qt::WA_TransparentForMouseEvents);
+    widget->setAttribute(Qt::WA_StyledBackground);
     widget->setStyleSheet( "border: 2px solid #7E00FF; background: rgba(126,25,227,0.125)");
-    widget->resize(55, 40);
-    widget->setVisible(false);
+    widget->resize(ZOOM_HANDLE_WIDTH, CAROUSEL_LINE_HEIGHT);
+    widget->setCursor(Qt::OpenHandCursor);
+    widget->installEventFilter(this);
     return widget;
 }
 
 
+// Places the handle on the closest line, clamped to the line extent
+void SingleLevelCarousel::moveZoomHandle(QPoint pos)
+{
+    const QPoint backOrigin  = m_backLine->mapTo(m_synopticContainer, QPoint(0,0));
+    const QPoint frontOrigin = m_frontLine->mapTo(m_synopticContainer, QPoint(0,0));
+    const int    handleCenter = pos.y() + m_zoomHandle->height()/2;
+
+    if (qAbs(handleCenter - backOrigin.y() - m_backLine->height()/2) <=
+        qAbs(handleCenter - frontOrigin.y() - m_frontLine->height()/2))
+        m_zoomLine = m_backLine;
+    else
+        m_zoomLine = m_frontLine;
+
+    const QPoint origin = (m_zoomLine == m_backLine) ? backOrigin : frontOrigin;
+    const int    maxX   = origin.x() + m_zoomLine->width() - m_zoomHandle->width();
+
+    m_zoomHandle->move(qBound(origin.x(), pos.x(), qMax(origin.x(), maxX)), origin.y());
+
+    updateZoomWindow();
+}
+
+
+// Resolves the first and last buckets under the handle and shows them in the zoom window
+void SingleLevelCarousel::updateZoomWindow()
+{
+    if (m_zoomLine == nullptr)
+        return;
+
+    const int lineX = m_zoomHandle->x() - m_zoomLine->mapTo(m_synopticContainer, QPoint(0,0)).x();
+    const int lastX = qMin(lineX + m_zoomHandle->width(), m_zoomLine->width()) - 1;
+
+    // The buckets are transparent for the mouse, childAt() would not find them
+    RectangleWidget* firstBucket = qobject_cast<RectangleWidget*>(m_clickDispatcher->cellAt(m_zoomLine, qMax(lineX, 0)));
+    RectangleWidget* lastBucket  = qobject_cast<RectangleWidget*>(m_clickDispatcher->cellAt(m_zoomLine, lastX));
+
+    if (firstBucket && lastBucket)
+        m_zoomWindow->setWindow(qMin(firstBucket->id(), lastBucket->id()), qMax(firstBucket->id(), lastBucket->id()));
+}
+
+
+bool SingleLevelCarousel::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_zoomHandle)
+    {
+        if (event->type() == QEvent::MouseButtonPress)
+        {
+            m_zoomDragOffset = static_cast<QMouseEvent*>(event)->pos();
+            m_zoomHandle->setCursor(Qt::ClosedHandCursor);
+            return true;
+        }
+        else if (event->type() == QEvent::MouseMove)
+        {
+            QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+
+            if (mouseEvent->buttons() & Qt::LeftButton)
+                moveZoomHandle(m_zoomHandle->mapTo(m_synopticContainer, mouseEvent->pos()) - m_zoomDragOffset);
+
+            return true;
+        }
+        else if (event->type() == QEvent::MouseButtonRelease)
+        {
+            m_zoomHandle->setCursor(Qt::OpenHandCursor);
+            return true;
+        }
+    }
+
+    return QWidget::eventFilter(watched, event);
+}
+
+
+void SingleLevelCarousel::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+
+    // Lines are laid out only once shown : start the handle at the beginning of the back line
+    if (m_zoomLine == nullptr)
+        moveZoomHandle(m_backLine->mapTo(m_synopticContainer, QPoint(0,0)));
+}
+
+
 void SingleLevelCarousel::on_synopticRightBtnClicked()
 {
    m_scrollArea->horizontalScrollBar()->setValue(m_scrollArea->horizontalScrollBar()->value() + m_synopticAvailableWidth);
@@ -238,7 +469,24 @@ void SingleLevelCarousel::on_synopticLeftBtnClicked()
    m_synopticRightBtn->show();
 }
 
-void SingleLevelCarousel::on_bucketClick()
+// A clicked bucket is brought into the zoom window : the handle is centred on it
+void SingleLevelCarousel::on_bucketClicked(int id, ConveyorSide side, ConveyorLevel level, Qt::KeyboardModifiers modifiers)
 {
+    Q_UNUSED(side);
+    Q_UNUSED(level);
+    Q_UNUSED(modifiers);
+
+    if (id < 0 || id >= m_buckets.size() || m_zoomHandle == nullptr)
+        return;
+
+    const RectangleWidget* bucket = m_buckets[id];
+    const QPoint center = bucket->mapTo(m_synopticContainer, bucket->rect().center());
 
+    moveZoomHandle(center - QPoint(m_zoomHandle->width()/2, m_zoomHandle->height()/2));
+}
+
+void SingleLevelCarousel::on_bucketsChanged(int first, int last)
+{
+    for (int i = first; i <= last; i++)
+        m_buckets[i]->setColor(BucketPlate::stateColor(m_model->state(i)));
 }
@@ -5,7 +5,12 @@
 #include <QHBoxLayout>
 #include <QScrollArea>
 #include <QScrollBar>
+#include <QTimer>
+#include <QPixmap>
 #include "RectangleWidget.h"
+#include "CarouselModel.h"
+#include "ZoomWindowWidget.h"
+#include "BucketClickDispatcher.h"
 
 namespace CarouselSL
 {
@@ -23,17 +28,32 @@ class SingleLevelCarousel: public QWidget
 public:
     explicit SingleLevelCarousel(QRect geoRect, int nbBuckets, QWidget *parent);
 
+    CarouselModel* model() const { return m_model; }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+
 private:
-    QWidget* createCarouselLine     (int nb_buckets);
+    QWidget* createCarouselLine     (int nb_buckets, ConveyorSide side);
     QWidget* createLevelContainer   ();
     QWidget* createSynopticContainer();
     QWidget* createSynopticView     ();
     QWidget* createZoomHandle       ();
+    void     sizeLine               (const QVector<RectangleWidget*>& buckets);
+    QRegion  levelMask              (int levelWidgetWidth) const;
+    void     relayout               ();
+    void     settleResize           ();
+    void     moveZoomHandle         (QPoint pos);
+    void     updateZoomWindow       ();
 
 private slots:
     void on_synopticRightBtnClicked();
     void on_synopticLeftBtnClicked();
-    void on_bucketClick();
+    void on_bucketClicked(int id, ConveyorSide side, ConveyorLevel level, Qt::KeyboardModifiers modifiers);
+    void on_bucketsChanged(int first, int last);
 
 private:
     int   NB_BUCKETS;
@@ -44,17 +64,32 @@ private:
     int   m_bucketsAvailableWidth;
 
     QVector<RectangleWidget*> m_buckets;
+    BucketClickDispatcher*    m_clickDispatcher;
     QWidget*       m_backLine;
     QWidget*       m_frontLine;
 
     QWidget*       m_synoptic;
     QWidget*       m_synopticContainer;
+    QWidget*       m_levelContainer;
+    QWidget*       m_linesContainer;
+    QWidget*       m_linesSeparator;
+    QSpacerItem*   m_levelSpacer;
     QPushButton*   m_synopticRightBtn;
     QPushButton*   m_synopticLeftBtn;
 
     QScrollArea*   m_scrollArea;
 
     QWidget*       m_zoomHandle;
+    QWidget*       m_zoomLine;
+    QPoint         m_zoomDragOffset;
+
+    CarouselModel*    m_model;
+    ZoomWindowWidget* m_zoomWindow;
+
+    // Live window drag, as BasicCarousel
+    QTimer*        m_relayoutTimer;
+    QPixmap        m_resizePreview;
+    QRectF         m_previewGeometry;
 };
 
 #endif // SINGLELEVELCAROUSEL_H
@@ -0,0 +1,229 @@
+#include "SorterSimulator.h"
+
+static const int TICK_INTERVAL = 20;        // ms, 50 Hz
+
+SorterSimulator::SorterSimulator(const SorterSimulatorConfig& config, QObject *parent)
+    : QObject{parent},
+      m_config(config),
+      m_random(config.seed),
+      m_timer(new QTimer(this)),
+      m_stepBudget(0.0)
+{
+    QVector<ConveyorLevel> levels;
+
+    if (m_config.levels == ConveyorLevel::BOTH)
+        levels = { ConveyorLevel::LOWER, ConveyorLevel::UPPER };
+    else
+        levels = { m_config.levels };
+
+    const int nbOutputs = 2*m_config.outputsPerSide;
+
+    for (ConveyorLevel conveyorLevel : levels)
+    {
+        Level level;
+        level.level         = conveyorLevel;
+        level.model         = new CarouselModel(m_config.bucketCount, this);
+        level.destination   = QVector<int>(m_config.bucketCount, -1);
+        level.arrivals      = QVector<QVector<int>>(m_config.bucketCount);
+        level.outputStates  = QVector<quint8>(nbOutputs, static_cast<quint8>(OutputTrayState::ENABLED));
+        level.containerFill = QVector<int>(nbOutputs, 0);
+        level.step          = 0;
+        m_levels.append(level);
+    }
+
+    m_timer->setInterval(TICK_INTERVAL);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &SorterSimulator::on_timer);
+}
+
+CarouselModel* SorterSimulator::model(ConveyorLevel level) const
+{
+    for (const Level& simulatedLevel : m_levels)
+    {
+        if (simulatedLevel.level == level)
+            return simulatedLevel.model;
+    }
+
+    return nullptr;
+}
+
+void SorterSimulator::start()
+{
+    // Views start from the simulator initial state, not from their own defaults
+    for (const Level& level : qAsConst(m_levels))
+    {
+        for (int output = 0; output < level.outputStates.size(); output++)
+        {
+            const ConveyorSide side = output < m_config.outputsPerSide ? ConveyorSide::FRONT : ConveyorSide::BACK;
+            const int index = output % m_config.outputsPerSide;
+
+            emit outputStateChanged(level.level, side, index, static_cast<OutputTrayState>(level.outputStates[output]));
+            emit containerStateChanged(level.level, side, index,
+                                       level.containerFill[output] > 0 ? ContainerTrayState::NOT_EMPTY : ContainerTrayState::EMPTY);
+        }
+    }
+
+    m_timer->start();
+}
+
+void SorterSimulator::stop()
+{
+    m_timer->stop();
+}
+
+void SorterSimulator::on_timer()
+{
+    step();
+}
+
+void SorterSimulator::step()
+{
+    // Fixed time step : the same seed always gives the same events
+    m_stepBudget += m_config.bucketsPerSecond*TICK_INTERVAL/1000.0;
+
+    while (m_stepBudget >= 1.0)
+    {
+        for (Level& level : m_levels)
+            advanceLevel(level);
+
+        m_stepBudget -= 1.0;
+    }
+
+    for (Level& level : m_levels)
+        toggleInhibitions(level);
+}
+
+// Uniform in [0, 1), independent of the standard library distributions
+double SorterSimulator::random()
+{
+    return m_random()/4294967296.0;
+}
+
+// Front outputs are spread on the first half of the slots, back outputs on the second half
+int SorterSimulator::outputSlot(int output) const
+{
+    const int half = m_config.bucketCount/2;
+
+    if (output < m_config.outputsPerSide)
+        return output*half/m_config.outputsPerSide;
+
+    return half + (output - m_config.outputsPerSide)*(m_config.bucketCount - half)/m_config.outputsPerSide;
+}
+
+void SorterSimulator::advanceLevel(Level& level)
+{
+    CarouselModel* model = level.model;
+    const int nbBuckets = m_config.bucketCount;
+
+    level.step++;
+    model->setPosition(model->position() + 1);
+
+    // Buckets arriving at their output this step
+    QVector<int>& arrivals = level.arrivals[level.step % nbBuckets];
+
+    for (int id : qAsConst(arrivals))
+        discharge(level, id);
+
+    arrivals.clear();
+
+    for (int station = 0; station < m_config.injectionStations; station++)
+    {
+        const int slot = station*nbBuckets/m_config.injectionStations;
+        const int id = model->idAtSlot(slot);
+
+        switch (model->state(id))
+        {
+        case BucketState::FAILURE:
+            if (random() < m_config.recoveryRate)
+                model->setState(id, BucketState::EMPTY);
+            break;
+        case BucketState::SORTED:
+        case BucketState::REJECTED:
+            // The bucket comes back unloaded and can be loaded again right away
+            model->setState(id, BucketState::EMPTY);
+            Q_FALLTHROUGH();
+        case BucketState::EMPTY:
+        {
+            if (random() >= m_config.injectionRate)
+                break;
+
+            if (random() < m_config.failureRate)
+            {
+                model->setState(id, BucketState::FAILURE);
+                break;
+            }
+
+            const int output = int(m_random() % quint32(2*m_config.outputsPerSide));
+            int distance = (slot - outputSlot(output) + nbBuckets) % nbBuckets;
+            if (distance == 0)
+                distance = nbBuckets;
+
+            level.destination[id] = output;
+            level.arrivals[(level.step + distance) % nbBuckets].append(id);
+            model->setState(id, BucketState::INJECTED);
+            break;
+        }
+        default:;
+        }
+    }
+}
+
+void SorterSimulator::discharge(Level& level, int id)
+{
+    const int output = level.destination[id];
+    level.destination[id] = -1;
+
+    // Disabled on the way
+    if (output < 0 || level.model->state(id) != BucketState::INJECTED)
+        return;
+
+    if (random() < m_config.failureRate)
+    {
+        level.model->setState(id, BucketState::FAILURE);
+        return;
+    }
+
+    if (level.outputStates[output] != static_cast<quint8>(OutputTrayState::ENABLED) || random() < m_config.rejectRate)
+    {
+        level.model->setState(id, BucketState::REJECTED);
+        return;
+    }
+
+    level.model->setState(id, BucketState::SORTED);
+
+    const ConveyorSide side = output < m_config.outputsPerSide ? ConveyorSide::FRONT : ConveyorSide::BACK;
+    const int index = output % m_config.outputsPerSide;
+    int& fill = level.containerFill[output];
+
+    if (++fill == 1)
+        emit containerStateChanged(level.level, side, index, ContainerTrayState::NOT_EMPTY);
+
+    if (fill >= m_config.containerCapacity)
+    {
+        fill = 0;
+        emit containerStateChanged(level.level, side, index, ContainerTrayState::EJECTED);
+    }
+}
+
+void SorterSimulator::toggleInhibitions(Level& level)
+{
+    const double probability = m_config.inhibitionRate*TICK_INTERVAL/60000.0;
+
+    for (int output = 0; output < level.outputStates.size(); output++)
+    {
+        if (random() >= probability)
+            continue;
+
+        quint8& state = level.outputStates[output];
+
+        if (state == static_cast<quint8>(OutputTrayState::ENABLED))
+            state = quint8(1 + m_random() % 3);     // one of the INHIBITED states
+        else
+            state = static_cast<quint8>(OutputTrayState::ENABLED);
+
+        emit outputStateChanged(level.level,
+                                output < m_config.outputsPerSide ? ConveyorSide::FRONT : ConveyorSide::BACK,
+                                output % m_config.outputsPerSide,
+                                static_cast<OutputTrayState>(state));
+    }
+}
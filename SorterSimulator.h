@@ -0,0 +1,84 @@
+#ifndef SORTERSIMULATOR_H
+#define SORTERSIMULATOR_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <random>
+#include "CarouselModel.h"
+
+struct SorterSimulatorConfig
+{
+    quint32       seed                = 1;
+    int           bucketCount         = 800;
+    int           injectionStations   = 4;
+    int           outputsPerSide      = 100;
+    ConveyorLevel levels              = ConveyorLevel::BOTH;
+
+    double        bucketsPerSecond    = 10.0;   // belt speed
+    double        injectionRate       = 0.6;    // probability an empty bucket is loaded at a station
+    double        rejectRate          = 0.03;
+    double        failureRate         = 0.005;
+    double        recoveryRate        = 0.5;    // probability a failed bucket is repaired at a station
+    double        inhibitionRate      = 0.01;   // output inhibition toggles per output and per minute
+    int           containerCapacity   = 40;
+};
+
+//---------------------------------------------------------------------------------------
+// class SorterSimulator
+// Deterministic stand-in for the PLC : for a given seed and configuration it always
+// produces the same sequence of bucket, output and container events.
+// Time advances by a fixed step per tick, it never depends on the wall clock.
+//---------------------------------------------------------------------------------------
+
+class SorterSimulator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SorterSimulator(const SorterSimulatorConfig& config, QObject *parent = nullptr);
+
+    const SorterSimulatorConfig& config() const { return m_config; }
+
+    // nullptr if the level is not simulated
+    CarouselModel* model(ConveyorLevel level) const;
+
+    void start();
+    void stop();
+
+    // Advances the simulation by one tick, also usable without the timer for benchmarks
+    void step();
+
+signals:
+    void outputStateChanged(ConveyorLevel level, ConveyorSide side, int index, OutputTrayState state);
+    void containerStateChanged(ConveyorLevel level, ConveyorSide side, int index, ContainerTrayState state);
+
+private:
+    struct Level
+    {
+        ConveyorLevel       level;
+        CarouselModel*      model;
+        QVector<int>        destination;        // output of each injected bucket, -1 if none
+        QVector<QVector<int>> arrivals;         // time wheel : buckets reaching their output, per step
+        QVector<quint8>     outputStates;       // both sides, front first
+        QVector<int>        containerFill;
+        int                 step;
+    };
+
+    void   advanceLevel(Level& level);
+    void   discharge(Level& level, int id);
+    void   toggleInhibitions(Level& level);
+    int    outputSlot(int output) const;
+    double random();
+
+private slots:
+    void on_timer();
+
+private:
+    SorterSimulatorConfig   m_config;
+    QVector<Level>          m_levels;
+    std::mt19937            m_random;
+    QTimer*                 m_timer;
+    double                  m_stepBudget;
+};
+
+#endif // SORTERSIMULATOR_H
@@ -0,0 +1,261 @@
+#include "StallWatchdog.h"
+#include "TraceRecorder.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+#ifdef Q_OS_LINUX
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#endif
+
+static const int PING_INTERVAL      = 50;       // ms
+static const int IDLE_PING_INTERVAL = 1000;     // ms, once the carousel is stopped
+static const int IDLE_DELAY         = 2000;     // ms without transition nor rotation
+static const int DEFAULT_THRESHOLD  = 200;      // ms
+static const int SAMPLE_TIMEOUT     = 100;      // ms
+static const int MAX_FRAMES         = 64;
+static const int TRACE_MARKERS      = 32;
+
+#ifdef Q_OS_LINUX
+// Filled by the signal handler on the GUI thread, read by the watchdog
+static void*            s_frames[MAX_FRAMES];
+static std::atomic<int> s_frameCount(0);
+static std::atomic<bool> s_sampled(false);
+
+static void sampleHandler(int signal)
+{
+    Q_UNUSED(signal);
+    s_frameCount.store(backtrace(s_frames, MAX_FRAMES), std::memory_order_relaxed);
+    s_sampled.store(true, std::memory_order_release);
+}
+#endif
+
+StallWatchdog::StallWatchdog(CarouselModel* model, const QString& reportFileName, QObject *parent)
+    : QThread{parent},
+      m_model(model),
+      m_reportFileName(reportFileName),
+      m_threshold(DEFAULT_THRESHOLD),
+      m_lastPong(0),
+      m_bucketCount(model->bucketCount()),
+      m_updateRate(0),
+      m_pingPending(false),
+      m_idle(false),
+      m_pingCount(0),
+      m_guiThread(QThread::currentThreadId()),
+      m_lastTransitions(0),
+      m_lastRateSample(0),
+      m_activityTransitions(0),
+      m_activityPosition(model->position()),
+      m_lastActivity(0)
+{
+    m_clock.start();
+    connectModel();
+
+#ifdef Q_OS_LINUX
+    // backtrace() loads its unwinder on first use, which must not happen inside the handler
+    void* frame;
+    backtrace(&frame, 1);
+
+    struct sigaction action = {};
+    action.sa_handler = sampleHandler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR2, &action, nullptr);
+#endif
+}
+
+void StallWatchdog::setModel(CarouselModel* model)
+{
+    if (model == m_model)
+        return;
+
+    m_model = model;
+    m_bucketCount.store(model->bucketCount());
+    m_lastTransitions = model->transitionCount();
+    m_lastRateSample = m_clock.elapsed();
+    m_activityTransitions = model->transitionCount();
+    m_activityPosition = model->position();
+    connectModel();
+    on_activity();
+}
+
+void StallWatchdog::connectModel()
+{
+    disconnect(m_bucketsConnection);
+    disconnect(m_positionConnection);
+
+    m_bucketsConnection  = connect(m_model, &CarouselModel::bucketsChanged, this, &StallWatchdog::on_activity);
+    m_positionConnection = connect(m_model, &CarouselModel::positionChanged, this, &StallWatchdog::on_activity);
+}
+
+StallWatchdog::~StallWatchdog()
+{
+    stop();
+}
+
+void StallWatchdog::stop()
+{
+    requestInterruption();
+
+    {
+        QMutexLocker locker(&m_wakeMutex);
+        m_wake.wakeAll();
+    }
+
+    wait();
+}
+
+void StallWatchdog::run()
+{
+    bool reported = false;
+    qint64 pingTime = 0;
+
+    while (!isInterruptionRequested())
+    {
+        if (!m_pingPending.load())
+        {
+            m_pingPending.store(true);
+            m_pingCount.fetch_add(1);
+            pingTime = m_clock.elapsed();
+            reported = false;
+
+            // This object lives in the GUI thread : the pong runs there once the event loop gets to it
+            QMetaObject::invokeMethod(this, [this]() { on_pong(); }, Qt::QueuedConnection);
+        }
+        else
+        {
+            // From the ping rather than the last pong, which is up to a second older while idle
+            const qint64 stall = m_clock.elapsed() - qMax(pingTime, m_lastPong.load());
+
+            if (!reported && stall > m_threshold)
+            {
+                sampleGuiThread();
+                writeReport(stall);
+                reported = true;
+            }
+        }
+
+        // A stopped line is pinged once a second, a stall (history seek, export, restore) is
+        // still caught. The first notification of the model brings the fast rate back at once
+        QMutexLocker locker(&m_wakeMutex);
+
+        if (m_idle.load())
+        {
+            if (!isInterruptionRequested())
+                m_wake.wait(&m_wakeMutex, IDLE_PING_INTERVAL);
+        }
+        else
+        {
+            locker.unlock();
+            msleep(PING_INTERVAL);
+        }
+    }
+}
+
+// GUI thread
+void StallWatchdog::on_pong()
+{
+    const qint64 now = m_clock.elapsed();
+
+    if (now - m_lastRateSample >= 1000)
+    {
+        const quint64 transitions = m_model->transitionCount();
+        m_updateRate.store(int((transitions - m_lastTransitions)*1000/quint64(now - m_lastRateSample)));
+        m_lastTransitions = transitions;
+        m_lastRateSample = now;
+    }
+
+    if (m_model->transitionCount() != m_activityTransitions || m_model->position() != m_activityPosition)
+    {
+        m_activityTransitions = m_model->transitionCount();
+        m_activityPosition = m_model->position();
+        m_lastActivity = now;
+    }
+
+    {
+        QMutexLocker locker(&m_wakeMutex);
+        m_idle.store(now - m_lastActivity > IDLE_DELAY);
+    }
+
+    m_bucketCount.store(m_model->bucketCount());
+    m_lastPong.store(now);
+    m_pingPending.store(false);
+}
+
+// GUI thread, at every notification of the model : only the first one after a quiet period
+// takes the lock
+void StallWatchdog::on_activity()
+{
+    if (!m_idle.load())
+        return;
+
+    QMutexLocker locker(&m_wakeMutex);
+    m_lastActivity = m_clock.elapsed();
+    m_idle.store(false);
+    m_wake.wakeAll();
+}
+
+void StallWatchdog::sampleGuiThread()
+{
+#ifdef Q_OS_LINUX
+    s_sampled.store(false);
+    s_frameCount.store(0);
+
+    pthread_kill(reinterpret_cast<pthread_t>(m_guiThread), SIGUSR2);
+
+    for (int waited = 0; !s_sampled.load(std::memory_order_acquire) && waited < SAMPLE_TIMEOUT; waited++)
+        msleep(1);
+#endif
+}
+
+void StallWatchdog::writeReport(qint64 stallMs)
+{
+    QFile file(m_reportFileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        return;
+
+    QTextStream out(&file);
+
+    out << "=== GUI stall " << QDateTime::currentDateTime().toString(Qt::ISODateWithMs)
+        << " : " << stallMs << " ms without event processing\n";
+    out << "buckets: " << m_bucketCount.load() << ", update rate: " << m_updateRate.load() << " transitions/s\n";
+
+    out << "--- GUI thread backtrace\n";
+#ifdef Q_OS_LINUX
+    const int frameCount = s_sampled.load(std::memory_order_acquire) ? s_frameCount.load() : 0;
+    char** symbols = frameCount > 0 ? backtrace_symbols(s_frames, frameCount) : nullptr;
+
+    for (int i = 0; i < frameCount; i++)
+        out << "  #" << i << " " << (symbols ? symbols[i] : "?") << "\n";
+
+    free(symbols);
+
+    if (frameCount == 0)
+        out << "  (no sample)\n";
+#else
+    out << "  (sampling only available on Linux)\n";
+#endif
+
+    out << "--- last trace markers\n";
+    const QVector<TraceEvent> events = TraceRecorder::lastGuiEvents(TRACE_MARKERS);
+
+    for (const TraceEvent& event : events)
+    {
+        out << "  " << event.name << " " << event.duration/1000 << " us";
+
+        if (event.count > 1)
+            out << " (" << event.count << " items)";
+
+        out << "\n";
+    }
+
+    if (events.isEmpty())
+        out << "  (none, build with CAROUSEL_TRACE)\n";
+
+    out << "\n";
+}
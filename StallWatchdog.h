@@ -0,0 +1,76 @@
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QThread>
+#include <QString>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <atomic>
+#include "CarouselModel.h"
+
+//---------------------------------------------------------------------------------------
+// class StallWatchdog
+// Pings the GUI event loop from its own thread. When a ping stays unanswered longer
+// than the threshold, the GUI thread backtrace is sampled (SIGUSR2 handler, Linux only)
+// and a report with the last trace markers and the carousel load goes to the stall file.
+// Once the model has been quiet for a while, pings slow down to one a second until the
+// model notifies a transition or a rotation.
+//---------------------------------------------------------------------------------------
+
+class StallWatchdog : public QThread
+{
+    Q_OBJECT
+public:
+    explicit StallWatchdog(CarouselModel* model, const QString& reportFileName, QObject *parent = nullptr);
+    ~StallWatchdog();
+
+    void setThreshold(int ms) { m_threshold = ms; }
+    void stop();
+
+    // GUI thread, the load is then measured on the model shown (history, replay)
+    void setModel(CarouselModel* model);
+
+    // Pings sent so far
+    quint64 pingCount() const { return m_pingCount.load(); }
+
+protected:
+    void run() override;
+
+private:
+    void on_pong();
+    void on_activity();
+    void connectModel();
+    void writeReport(qint64 stallMs);
+    void sampleGuiThread();
+
+private:
+    CarouselModel*          m_model;
+    QString                 m_reportFileName;
+    int                     m_threshold;
+
+    std::atomic<qint64>     m_lastPong;         // ms on m_clock
+    std::atomic<int>        m_bucketCount;
+    std::atomic<int>        m_updateRate;       // transitions per second, sampled on the GUI thread
+    std::atomic<bool>       m_pingPending;
+    std::atomic<bool>       m_idle;             // no activity of the model lately, pings slow down
+    std::atomic<quint64>    m_pingCount;
+
+    // The thread waits on it between two idle pings
+    QMutex                  m_wakeMutex;
+    QWaitCondition          m_wake;
+
+    Qt::HANDLE              m_guiThread;
+    QElapsedTimer           m_clock;
+
+    // Only touched on the GUI thread
+    quint64                 m_lastTransitions;
+    qint64                  m_lastRateSample;
+    quint64                 m_activityTransitions;
+    int                     m_activityPosition;
+    qint64                  m_lastActivity;
+    QMetaObject::Connection m_bucketsConnection;
+    QMetaObject::Connection m_positionConnection;
+};
+
+#endif // STALLWATCHDOG_H
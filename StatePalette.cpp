@@ -0,0 +1,100 @@
+#include "StatePalette.h"
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+// Defaults, in the order of the enum values of each section
+static constexpr std::array<QRgb, PALETTE_SIZE> DEFAULT_PALETTE =
+{
+    // BucketState
+    qRgb(0xFF, 0xFF, 0xFF),     // EMPTY
+    qRgb(0x99, 0xCC, 0xFF),     // INJECTED
+    qRgb(0x73, 0xE6, 0x00),     // SORTED
+    qRgb(0xFF, 0x9D, 0x3B),     // REJECTED
+    qRgb(0xE4, 0x34, 0x34),     // FAILURE
+    qRgba(0, 0, 0, 0),          // UNKNOWN, hatched by the views
+    qRgb(0x80, 0x80, 0x80),     // DISABLED
+
+    // OutputTrayState
+    qRgb(0xE1, 0xF4, 0xFF),     // ENABLED
+    qRgb(0x82, 0x82, 0xC4),     // INHIBITED_U
+    qRgb(0x6D, 0xAD, 0xAD),     // INHIBITED_PATD
+    qRgb(0xB8, 0x8C, 0x5A),     // INHIBITED_SD
+
+    // ContainerTrayState
+    qRgb(0xF9, 0xF6, 0xE8),     // EMPTY
+    qRgb(0xFA, 0xC1, 0x91),     // NOT_EMPTY
+    qRgb(0xF4, 0x42, 0x42),     // UNKNOWN
+    qRgb(0xF9, 0xF6, 0xE8)      // EJECTED, hatched by the views
+};
+
+static const char* const BUCKET_STATE_NAMES[BUCKET_STATE_COUNT] =
+    { "EMPTY", "INJECTED", "SORTED", "REJECTED", "FAILURE", "UNKNOWN", "DISABLED" };
+
+static const char* const OUTPUT_TRAY_STATE_NAMES[OUTPUT_TRAY_STATE_COUNT] =
+    { "ENABLED", "INHIBITED_U", "INHIBITED_PATD", "INHIBITED_SD" };
+
+static const char* const CONTAINER_TRAY_STATE_NAMES[CONTAINER_TRAY_STATE_COUNT] =
+    { "EMPTY", "NOT_EMPTY", "UNKNOWN", "EJECTED" };
+
+std::array<QRgb, PALETTE_SIZE> StatePalette::s_table = DEFAULT_PALETTE;
+
+// Parses one section into a copy of the table, names are the enum names
+static bool loadSection(const QJsonObject& theme, const char* section, const char* const names[], int count,
+                        QRgb* colors)
+{
+    const QJsonObject entries = theme.value(section).toObject();
+
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+    {
+        int index = 0;
+        while (index < count && it.key() != QLatin1String(names[index]))
+            index++;
+
+        const QColor color(it.value().toString());
+
+        if (index == count || !color.isValid())
+        {
+            qWarning() << "Theme :" << section << it.key() << "ignored";
+            return false;
+        }
+
+        colors[index] = color.rgba();
+    }
+
+    return true;
+}
+
+// The colours are parsed here once, the views only ever read the packed table
+bool StatePalette::loadTheme(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+
+    if (!document.isObject())
+        return false;
+
+    const QJsonObject theme = document.object();
+    std::array<QRgb, PALETTE_SIZE> table = DEFAULT_PALETTE;
+
+    if (!loadSection(theme, "bucket", BUCKET_STATE_NAMES, BUCKET_STATE_COUNT,
+                     table.data() + PALETTE_BUCKET_OFFSET) ||
+        !loadSection(theme, "output", OUTPUT_TRAY_STATE_NAMES, OUTPUT_TRAY_STATE_COUNT,
+                     table.data() + PALETTE_OUTPUT_OFFSET) ||
+        !loadSection(theme, "container", CONTAINER_TRAY_STATE_NAMES, CONTAINER_TRAY_STATE_COUNT,
+                     table.data() + PALETTE_CONTAINER_OFFSET))
+        return false;
+
+    s_table = table;
+    return true;
+}
+
+void StatePalette::resetTheme()
+{
+    s_table = DEFAULT_PALETTE;
+}
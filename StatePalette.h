@@ -0,0 +1,74 @@
+#ifndef STATEPALETTE_H
+#define STATEPALETTE_H
+
+#include <QColor>
+#include <QString>
+#include <array>
+#include <Conveyor/Conveyor_T2K.h>
+
+//---------------------------------------------------------------------------------------
+// class StatePalette
+// State colours of the buckets, output trays and containers, packed in one table indexed
+// by the enum values. Shared by the tray widgets and by the views painting their own
+// cells (walls, zoom window), so a lookup is an array read, never a colour parsing.
+// The table starts from compile-time defaults; a theme file may override it once at
+// startup, before the views are created.
+//---------------------------------------------------------------------------------------
+
+static const int BUCKET_STATE_COUNT         = static_cast<int>(BucketState::DISABLED) + 1;
+static const int OUTPUT_TRAY_STATE_COUNT    = static_cast<int>(OutputTrayState::INHIBITED_SD) + 1;
+static const int CONTAINER_TRAY_STATE_COUNT = static_cast<int>(ContainerTrayState::EJECTED) + 1;
+
+static const int PALETTE_BUCKET_OFFSET    = 0;
+static const int PALETTE_OUTPUT_OFFSET    = PALETTE_BUCKET_OFFSET + BUCKET_STATE_COUNT;
+static const int PALETTE_CONTAINER_OFFSET = PALETTE_OUTPUT_OFFSET + OUTPUT_TRAY_STATE_COUNT;
+static const int PALETTE_SIZE             = PALETTE_CONTAINER_OFFSET + CONTAINER_TRAY_STATE_COUNT;
+
+class StatePalette
+{
+public:
+    // Out of range values (corrupted telegrams) are transparent
+    static QRgb bucket(BucketState state)
+    {
+        return lookup(PALETTE_BUCKET_OFFSET, static_cast<int>(state), BUCKET_STATE_COUNT);
+    }
+
+    static QRgb output(OutputTrayState state)
+    {
+        return lookup(PALETTE_OUTPUT_OFFSET, static_cast<int>(state), OUTPUT_TRAY_STATE_COUNT);
+    }
+
+    static QRgb container(ContainerTrayState state)
+    {
+        return lookup(PALETTE_CONTAINER_OFFSET, static_cast<int>(state), CONTAINER_TRAY_STATE_COUNT);
+    }
+
+    // Operator attention : these states blink with the shared AlarmAnimator clock, in the
+    // tray widgets as in the walls. Only faults blink : an inhibition is an operator
+    // decision and UNKNOWN is the state of every container until the PLC reports it, so no
+    // output or container state is an alarm today
+    static bool isAlarm(BucketState state)
+    {
+        return state == BucketState::FAILURE || state == BucketState::REJECTED;
+    }
+
+    static bool isAlarm(OutputTrayState state) { Q_UNUSED(state); return false; }
+    static bool isAlarm(ContainerTrayState state) { Q_UNUSED(state); return false; }
+
+    // JSON object of sections ("bucket", "output", "container") mapping state names to
+    // colours, e.g. { "bucket": { "SORTED": "#73E600" } }. Missing entries keep their
+    // default. Returns false, leaving the table untouched, if the file cannot be used.
+    static bool loadTheme(const QString& fileName);
+
+    static void resetTheme();
+
+private:
+    static QRgb lookup(int offset, int index, int count)
+    {
+        return uint(index) < uint(count) ? s_table[offset + index] : 0;
+    }
+
+    static std::array<QRgb, PALETTE_SIZE> s_table;
+};
+
+#endif // STATEPALETTE_H
@@ -0,0 +1,212 @@
+#include "SynopticExporter.h"
+#include "StatePalette.h"
+#include "TraceRecorder.h"
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QTextStream>
+#include <QtConcurrent/QtConcurrentMap>
+
+// Fill declaration of a palette colour : #rrggbb has no alpha, transparent colours are not
+// filled and translucent ones get their opacity apart
+static QString cssFill(QRgb rgb)
+{
+    const int alpha = qAlpha(rgb);
+
+    if (alpha == 0)
+        return "fill:none";
+
+    const QString fill = "fill:" + QColor::fromRgba(rgb).name();
+    return alpha == 255 ? fill : fill + ";fill-opacity:" + QString::number(alpha/255.0, 'g', 3);
+}
+
+// Same as attributes
+static QString svgFill(QRgb rgb)
+{
+    const int alpha = qAlpha(rgb);
+
+    if (alpha == 0)
+        return "fill=\"none\"";
+
+    const QString fill = "fill=\"" + QColor::fromRgba(rgb).name() + '"';
+    return alpha == 255 ? fill : fill + " fill-opacity=\"" + QString::number(alpha/255.0, 'g', 3) + '"';
+}
+
+// Qt stores the quadratic curves as cubic ones
+static QString svgPath(const QPainterPath& path)
+{
+    QString d;
+    QTextStream stream(&d);
+
+    for (int i = 0; i < path.elementCount(); i++)
+    {
+        const QPainterPath::Element element = path.elementAt(i);
+
+        switch (element.type)
+        {
+        case QPainterPath::MoveToElement:      stream << 'M'; break;
+        case QPainterPath::LineToElement:      stream << 'L'; break;
+        case QPainterPath::CurveToElement:     stream << 'C'; break;
+        case QPainterPath::CurveToDataElement: stream << ' '; break;
+        }
+
+        stream << element.x << ',' << element.y;
+    }
+
+    return d;
+}
+
+SynopticExporter::SynopticExporter(CarouselHistory* history, QObject *parent)
+    : QObject{parent},
+      m_history(history),
+      m_size(EXPORT_WIDTH, EXPORT_HEIGHT)
+{
+    connect(&m_watcher, &QFutureWatcherBase::progressValueChanged, this,
+            [this](int done) { emit progress(done, m_watcher.progressMaximum()); });
+    connect(&m_watcher, &QFutureWatcherBase::finished, this, &SynopticExporter::on_finished);
+}
+
+// The jobs hold copies of the scene and states, the remaining ones are dropped
+SynopticExporter::~SynopticExporter()
+{
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+bool SynopticExporter::start(const QVector<qint64>& timestamps, const QString& directory, Format format)
+{
+    TRACE_SCOPE("SynopticExporter::start");
+
+    if (isRunning())
+        return false;
+
+    const int nbBuckets = m_history->model()->bucketCount();
+    const CarouselScene scene = m_renderer.scene(m_size, nbBuckets);
+
+    if (!scene.isValid() || !QDir().mkpath(directory))
+        return false;
+
+    const QString extension = format == PNG ? ".png" : ".svg";
+
+    // One forward replay of the history for all the instants, not a seek per instant
+    const QDir target(directory);
+    QVector<Frame> frames;
+    frames.reserve(timestamps.size());
+
+    m_history->statesAt(timestamps, [&](qint64 timestamp, const QVector<quint8>& states, int bcsPosition)
+    {
+        Frame frame;
+        frame.fileName = target.filePath("synoptic_" +
+                         QDateTime::fromMSecsSinceEpoch(timestamp).toString("yyyyMMdd_hhmmss_zzz") + extension);
+        frame.states = states;
+        frame.headOffset = CarouselModel::headOffsetOf(bcsPosition, nbBuckets);
+        frames.append(frame);
+    });
+
+    if (frames.isEmpty())
+        return false;
+
+    m_watcher.setFuture(QtConcurrent::mapped(frames, ExportFrame{scene, format}));
+    return true;
+}
+
+void SynopticExporter::cancel()
+{
+    m_watcher.cancel();
+}
+
+void SynopticExporter::on_finished()
+{
+    const QList<bool> results = m_watcher.future().results();
+    emit finished(results.count(true));
+}
+
+bool SynopticExporter::ExportFrame::operator()(const Frame& frame) const
+{
+    return format == PNG ? writePng(frame.fileName, scene, frame.states, frame.headOffset)
+                         : writeSvg(frame.fileName, scene, frame.states, frame.headOffset);
+}
+
+bool SynopticExporter::writePng(const QString& fileName, const CarouselScene& scene, const QVector<quint8>& states, int headOffset)
+{
+    TRACE_SCOPE("SynopticExporter::writePng");
+
+    const QImage image = CarouselRenderer::render(scene, states, headOffset);
+    return image.save(fileName, "PNG", EXPORT_PNG_QUALITY);
+}
+
+// Same layout as the rendered image : one class per bucket state, one rect per cell
+bool SynopticExporter::writeSvg(const QString& fileName, const CarouselScene& scene, const QVector<quint8>& states, int headOffset)
+{
+    TRACE_SCOPE("SynopticExporter::writeSvg");
+
+    if (!scene.isValid() || states.size() != scene.nbBuckets)
+        return false;
+
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    const int width = scene.size.width();
+    const int height = scene.size.height();
+
+    QTextStream svg(&file);
+
+    svg << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+        << "\" viewBox=\"0 0 " << width << ' ' << height << "\">\n"
+        << "<defs><pattern id=\"hatch\" width=\"8\" height=\"8\" patternUnits=\"userSpaceOnUse\">"
+        << "<path d=\"M0,8 L8,0\" stroke=\"#000000\"/></pattern></defs>\n"
+        << "<style>";
+
+    for (int i = 0; i < BUCKET_STATE_COUNT; i++)
+        svg << ".s" << i << '{' << cssFill(StatePalette::bucket(static_cast<BucketState>(i))) << '}';
+
+    svg << ".h{fill:url(#hatch)}</style>\n"
+        << "<rect width=\"" << width << "\" height=\"" << height << "\" " << svgFill(SYNOPTIC_BACKGROUND) << "/>\n";
+
+    for (bool flip : { true, false })
+        svg << "<path d=\"" << svgPath(CarouselRenderer::curvesPath(scene, flip)) << "\" " << svgFill(SYNOPTIC_CURVES_COLOR)
+            << " fill-rule=\"evenodd\" stroke=\"#000000\"/>\n";
+
+    // Strokes on the half pixel : the borders of two neighbour cells are the same line
+    svg << "<g stroke=\"#000000\">\n";
+
+    scene.visitCells(headOffset, [&](const QRect& cell, int id)
+    {
+        const quint8 packed = states[id];
+        const BucketState state = packed < BUCKET_STATE_COUNT ? static_cast<BucketState>(packed) : BucketState::UNKNOWN;
+        const int stateIndex = static_cast<int>(state);
+
+        svg << "<rect class=\"s" << stateIndex << "\" x=\"" << cell.x() + 0.5 << "\" y=\"" << cell.y() + 0.5
+            << "\" width=\"" << cell.width() << "\" height=\"" << cell.height() - 1 << "\"/>\n";
+
+        if (state == BucketState::UNKNOWN || state == BucketState::DISABLED)
+            svg << "<rect class=\"h\" x=\"" << cell.x() + 0.5 << "\" y=\"" << cell.y() + 0.5
+                << "\" width=\"" << cell.width() << "\" height=\"" << cell.height() - 1 << "\"/>\n";
+    },
+    [](const QRect&) {});
+
+    svg << "</g>\n";
+
+    if (!scene.labels.isEmpty())
+    {
+        svg << "<g font-family=\"Arial\" font-size=\"" << scene.fontSize
+            << "\" text-anchor=\"middle\" dominant-baseline=\"central\">\n";
+
+        scene.visitCells(headOffset, [&](const QRect& cell, int id)
+        {
+            svg << "<text x=\"" << cell.x() + cell.width()/2.0 << "\" y=\"" << cell.y() + cell.height()/2.0 << "\">"
+                << scene.labels[id] << "</text>\n";
+        },
+        [](const QRect&) {});
+
+        svg << "</g>\n";
+    }
+
+    svg << "</svg>\n";
+    svg.flush();
+
+    return svg.status() == QTextStream::Ok && file.error() == QFileDevice::NoError;
+}
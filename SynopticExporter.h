@@ -0,0 +1,79 @@
+#ifndef SYNOPTICEXPORTER_H
+#define SYNOPTICEXPORTER_H
+
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QFutureWatcher>
+#include "CarouselHistory.h"
+#include "CarouselRenderer.h"
+
+//---------------------------------------------------------------------------------------
+// class SynopticExporter
+// Writes the carousel synoptic at recorded instants to PNG or SVG files, for the shift
+// reports, without any widget. The instants are rebuilt from the history on the GUI
+// thread (the history is not shared) in a single forward replay, then rendered and
+// written in parallel by the global pool : PNG through CarouselRenderer, SVG streamed
+// as text.
+//---------------------------------------------------------------------------------------
+
+static const int EXPORT_WIDTH       = 1920;
+static const int EXPORT_HEIGHT      = 360;
+static const int EXPORT_PNG_QUALITY = 80;       // light deflate, the flat synoptics compress well anyway
+
+class SynopticExporter : public QObject
+{
+    Q_OBJECT
+public:
+    enum Format { PNG, SVG };
+
+    explicit SynopticExporter(CarouselHistory* history, QObject *parent = nullptr);
+    ~SynopticExporter();
+
+    void  setSize(const QSize& size) { m_size = size; }
+    QSize size() const { return m_size; }
+
+    // One file per instant recorded in the history (ascending), named after its time. False if an
+    // export is already running or none of the instants is available.
+    bool  start(const QVector<qint64>& timestamps, const QString& directory, Format format);
+    void  cancel();
+    bool  isRunning() const { return m_watcher.isRunning(); }
+
+    // Any thread
+    static bool writePng(const QString& fileName, const CarouselScene& scene, const QVector<quint8>& states, int headOffset);
+    static bool writeSvg(const QString& fileName, const CarouselScene& scene, const QVector<quint8>& states, int headOffset);
+
+signals:
+    void progress(int done, int total);
+    void finished(int written);
+
+private slots:
+    void on_finished();
+
+private:
+    struct Frame
+    {
+        QString         fileName;
+        QVector<quint8> states;
+        int             headOffset;
+    };
+
+    // Job of the pool, holds its own copy of the scene
+    struct ExportFrame
+    {
+        typedef bool result_type;
+
+        CarouselScene scene;
+        Format        format;
+
+        bool operator()(const Frame& frame) const;
+    };
+
+private:
+    CarouselHistory*        m_history;
+    CarouselRenderer        m_renderer;
+    QSize                   m_size;
+    QFutureWatcher<bool>    m_watcher;
+};
+
+#endif // SYNOPTICEXPORTER_H
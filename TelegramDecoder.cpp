@@ -0,0 +1,138 @@
+#include "TelegramDecoder.h"
+#include <QFile>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+// Byte -> (low nibble state, high nibble state), built at compile time
+struct NibbleTable
+{
+    quint8 pairs[256][2];
+
+    constexpr NibbleTable() : pairs()
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            pairs[i][0] = quint8(i & 0x0F);
+            pairs[i][1] = quint8(i >> 4);
+        }
+    }
+};
+
+static constexpr NibbleTable NIBBLES;
+
+static const qint64 CAPTURE_WINDOW = 64 << 20;     // bytes mapped at once, far above the largest frame
+
+TelegramDecoder::TelegramDecoder(CarouselModel* model, QObject *parent)
+    : QObject{parent},
+      m_model(model),
+      m_batch(model->bucketCount() + 1),
+      m_frameCount(0),
+      m_errorCount(0)
+{
+}
+
+int TelegramDecoder::feed(const uchar* data, int size)
+{
+    int offset = 0;
+
+    while (size - offset > TELEGRAM_HEADER_SIZE)
+    {
+        const uchar* frame = data + offset;
+
+        // Resynchronise on the next magic
+        if (qFromLittleEndian<quint16>(frame) != TELEGRAM_MAGIC)
+        {
+            offset++;
+            continue;
+        }
+
+        const int length = qFromLittleEndian<quint16>(frame + 2);
+        const int count  = qFromLittleEndian<quint16>(frame + 10);
+
+        if (length != TELEGRAM_HEADER_SIZE + (count + 1)/2 + 1)
+        {
+            m_errorCount++;
+            offset++;
+            continue;
+        }
+
+        if (size - offset < length)
+            break;
+
+        if (!decodeFrame(frame, length))
+        {
+            m_errorCount++;
+            offset++;
+            continue;
+        }
+
+        m_frameCount++;
+        offset += length;
+    }
+
+    return offset;
+}
+
+bool TelegramDecoder::decodeFrame(const uchar* frame, int length)
+{
+    quint8 checksum = 0;
+
+    for (int i = 0; i < length - 1; i++)
+        checksum ^= frame[i];
+
+    if (checksum != frame[length - 1])
+        return false;
+
+    const int bcsPosition = qFromLittleEndian<qint32>(frame + 4);
+    const int first       = qFromLittleEndian<quint16>(frame + 8);
+    const int count       = qMin(int(qFromLittleEndian<quint16>(frame + 10)), m_batch.size() - 1);
+
+    const uchar* packed = frame + TELEGRAM_HEADER_SIZE;
+    quint8* batch = m_batch.data();
+
+    for (int i = 0; i < (count + 1)/2; i++)
+        std::memcpy(batch + 2*i, NIBBLES.pairs[packed[i]], 2);
+
+    m_model->applyStates(first, batch, count, bcsPosition);
+
+    return true;
+}
+
+bool TelegramDecoder::decodeCapture(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+    {
+        qWarning() << "Cannot open telegram capture" << fileName;
+        return false;
+    }
+
+    const qint64 size = file.size();
+    qint64 offset = 0;
+
+    // feed() takes an int : the capture is mapped one window at a time, each window
+    // starting on the incomplete frame left by the previous one
+    while (offset < size)
+    {
+        const int length = int(qMin(size - offset, CAPTURE_WINDOW));
+        const uchar* data = file.map(offset, length);
+
+        if (!data)
+        {
+            qWarning() << "Cannot map telegram capture" << file.errorString();
+            return false;
+        }
+
+        const int consumed = feed(data, length);
+        file.unmap(const_cast<uchar*>(data));
+
+        if (offset + length == size || consumed == 0)
+            break;
+
+        offset += consumed;
+    }
+
+    return true;
+}
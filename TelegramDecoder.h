@@ -0,0 +1,53 @@
+#ifndef TELEGRAMDECODER_H
+#define TELEGRAMDECODER_H
+
+#include <QObject>
+#include <QVector>
+#include "CarouselModel.h"
+
+//---------------------------------------------------------------------------------------
+// Sorter telegram, little endian :
+//   0  quint16  magic (TELEGRAM_MAGIC)
+//   2  quint16  frame length, header and checksum included
+//   4  qint32   BCS position
+//   8  quint16  first bucket id
+//  10  quint16  bucket count
+//  12  states, 4 bits per bucket, low nibble first
+// end  quint8   xor of all the previous bytes
+//---------------------------------------------------------------------------------------
+
+static const quint16 TELEGRAM_MAGIC       = 0x5354;
+static const int     TELEGRAM_HEADER_SIZE = 12;
+
+//---------------------------------------------------------------------------------------
+// class TelegramDecoder
+// Parses telegrams in place from the receive buffer and applies each one to the model
+// as a single batch. Garbage is skipped until the next valid frame.
+//---------------------------------------------------------------------------------------
+
+class TelegramDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TelegramDecoder(CarouselModel* model, QObject *parent = nullptr);
+
+    // Returns the number of bytes consumed, an incomplete frame at the end is left in the buffer
+    int     feed(const uchar* data, int size);
+
+    // Decodes a recorded capture of any size, frameCount() tells how many telegrams it held
+    bool    decodeCapture(const QString& fileName);
+
+    quint64 frameCount() const { return m_frameCount; }
+    quint64 errorCount() const { return m_errorCount; }
+
+private:
+    bool    decodeFrame(const uchar* frame, int length);
+
+private:
+    CarouselModel*  m_model;
+    QVector<quint8> m_batch;        // sized once to the model, reused by every frame
+    quint64         m_frameCount;
+    quint64         m_errorCount;
+};
+
+#endif // TELEGRAMDECODER_H
@@ -0,0 +1,201 @@
+#include "TraceRecorder.h"
+#include <QFile>
+#include <QTextStream>
+#include <QMutex>
+#include <QThread>
+#include <QCoreApplication>
+#include <chrono>
+
+static const int    MAX_THREADS    = 16;
+static const qint64 ITEM_MERGE_GAP = 20000;    // ns between two items of the same pass
+static const int    READ_ATTEMPTS  = 4;
+
+// Buffers are registered once per thread and live until the process exits
+static std::atomic<int> s_threadCount(0);
+static std::atomic<void*> s_buffers[MAX_THREADS];
+static std::atomic<void*> s_guiBuffer(nullptr);
+
+qint64 TraceRecorder::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::threadBuffer()
+{
+    // Only the first event of a thread allocates
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if (buffer)
+        return buffer;
+
+    const int index = s_threadCount.fetch_add(1);
+
+    if (index >= MAX_THREADS)
+        return nullptr;
+
+    buffer = new ThreadBuffer();
+    buffer->threadIndex = index;
+    s_buffers[index].store(buffer, std::memory_order_release);
+
+    if (QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread())
+        s_guiBuffer.store(buffer, std::memory_order_release);
+
+    return buffer;
+}
+
+void TraceRecorder::write(Slot& slot, const char* name, qint64 start, qint64 duration, int count)
+{
+    const quint32 sequence = slot.sequence.load(std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.duration.store(duration, std::memory_order_relaxed);
+    slot.count.store(count, std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// False if the slot kept being rewritten meanwhile
+bool TraceRecorder::read(const Slot& slot, TraceEvent& event)
+{
+    for (int attempt = 0; attempt < READ_ATTEMPTS; attempt++)
+    {
+        const quint32 sequence = slot.sequence.load(std::memory_order_acquire);
+
+        if (sequence & 1)
+            continue;
+
+        event.name     = slot.name.load(std::memory_order_relaxed);
+        event.start    = slot.start.load(std::memory_order_relaxed);
+        event.duration = slot.duration.load(std::memory_order_relaxed);
+        event.count    = slot.count.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+            return event.name != nullptr;
+    }
+
+    return false;
+}
+
+void TraceRecorder::append(ThreadBuffer* buffer, const char* name, qint64 start, qint64 duration, int count)
+{
+    const quint64 head = buffer->head.load(std::memory_order_relaxed);
+
+    write(buffer->ring[head & (RING_SIZE - 1)], name, start, duration, count);
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void TraceRecorder::record(const char* name, qint64 start, qint64 duration)
+{
+    ThreadBuffer* buffer = threadBuffer();
+
+    if (buffer)
+        append(buffer, name, start, duration, 0);
+}
+
+// Extends the last event when it holds the previous items of the same pass : same name, no
+// scope recorded in between, and the previous item ended just before
+void TraceRecorder::recordItem(const char* name, qint64 start, qint64 duration)
+{
+    ThreadBuffer* buffer = threadBuffer();
+
+    if (!buffer)
+        return;
+
+    const quint64 head = buffer->head.load(std::memory_order_relaxed);
+
+    if (head > 0)
+    {
+        // Only this thread writes the slot, its own relaxed loads are exact
+        Slot& last = buffer->ring[(head - 1) & (RING_SIZE - 1)];
+        const qint64 lastStart = last.start.load(std::memory_order_relaxed);
+        const qint64 lastEnd   = lastStart + last.duration.load(std::memory_order_relaxed);
+        const int    lastCount = last.count.load(std::memory_order_relaxed);
+
+        if (last.name.load(std::memory_order_relaxed) == name && lastCount > 0 && start - lastEnd <= ITEM_MERGE_GAP)
+        {
+            write(last, name, lastStart, start + duration - lastStart, lastCount + 1);
+            return;
+        }
+    }
+
+    append(buffer, name, start, duration, 1);
+}
+
+QVector<TraceEvent> TraceRecorder::lastGuiEvents(int count)
+{
+    QVector<TraceEvent> events;
+    const ThreadBuffer* buffer = static_cast<const ThreadBuffer*>(s_guiBuffer.load(std::memory_order_acquire));
+
+    if (!buffer)
+        return events;
+
+    const quint64 head  = buffer->head.load(std::memory_order_acquire);
+    const quint64 first = head > quint64(count) ? head - count : 0;
+
+    TraceEvent event;
+
+    for (quint64 i = first; i < head; i++)
+    {
+        if (read(buffer->ring[i & (RING_SIZE - 1)], event))
+            events.append(event);
+    }
+
+    return events;
+}
+
+bool TraceRecorder::exportChromeTrace(const QString& fileName)
+{
+    QFile file(fileName);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+    out << "{\"traceEvents\":[\n";
+
+    bool firstEvent = true;
+    const int nbThreads = qMin(s_threadCount.load(), MAX_THREADS);
+
+    for (int t = 0; t < nbThreads; t++)
+    {
+        const ThreadBuffer* buffer = static_cast<const ThreadBuffer*>(s_buffers[t].load(std::memory_order_acquire));
+
+        if (!buffer)
+            continue;
+
+        const quint64 head  = buffer->head.load(std::memory_order_acquire);
+        const quint64 first = head > RING_SIZE ? head - RING_SIZE : 0;
+
+        for (quint64 i = first; i < head; i++)
+        {
+            TraceEvent event;
+
+            if (!read(buffer->ring[i & (RING_SIZE - 1)], event))
+                continue;
+
+            if (!firstEvent)
+                out << ",\n";
+            firstEvent = false;
+
+            // Chrome expects microseconds
+            out << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadIndex
+                << ",\"ts\":" << QString::number(event.start/1000.0, 'f', 3)
+                << ",\"dur\":" << QString::number(event.duration/1000.0, 'f', 3);
+
+            if (event.count > 0)
+                out << ",\"args\":{\"count\":" << event.count << "}";
+
+            out << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    return out.status() == QTextStream::Ok;
+}
@@ -0,0 +1,99 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QString>
+#include <QVector>
+#include <atomic>
+
+//---------------------------------------------------------------------------------------
+// Scoped trace markers of the update pipeline, compiled only with DEFINES += CAROUSEL_TRACE
+// TRACE_SCOPE(name) records a complete event in the ring buffer of the calling thread.
+// TRACE_ITEM(name) marks work done once per bucket or tray : consecutive items of the
+// same name closer than 20 us are merged into one event of the pass, so a
+// rotation of the whole carousel costs a few events instead of thousands.
+// Events are read from other threads (stall watchdog) : every slot of the ring is written
+// under its own sequence counter, a reader retries or skips a slot being written.
+// Names must be string literals : only the pointer is stored, nothing is allocated.
+//---------------------------------------------------------------------------------------
+
+#ifdef CAROUSEL_TRACE
+#define TRACE_SCOPE(name) TraceScope traceScope(name)
+#define TRACE_ITEM(name)  TraceScope traceScope(name, true)
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_ITEM(name)
+#endif
+
+struct TraceEvent
+{
+    const char* name;
+    qint64      start;          // ns, monotonic
+    qint64      duration;       // ns, from the first to the end of the last item when merged
+    int         count;          // merged items, 0 for a scope
+};
+
+class TraceRecorder
+{
+public:
+    static qint64 now();
+    static void   record(const char* name, qint64 start, qint64 duration);
+    static void   recordItem(const char* name, qint64 start, qint64 duration);
+
+    // Writes every buffered event in the Chrome trace format (chrome://tracing, Perfetto)
+    static bool   exportChromeTrace(const QString& fileName);
+
+    // Most recent events of the GUI thread, oldest first
+    static QVector<TraceEvent> lastGuiEvents(int count);
+
+private:
+    // Per thread. Items merged, a 2000-bucket carousel at 20 Hz records about ten events
+    // per tick : the ring holds over 30 s at the 2000 events/s of a loaded GUI thread
+    static const int RING_SIZE = 1 << 16;
+
+    struct Slot
+    {
+        std::atomic<quint32>     sequence;      // odd while written
+        std::atomic<const char*> name;
+        std::atomic<qint64>      start;
+        std::atomic<qint64>      duration;
+        std::atomic<int>         count;
+    };
+
+    struct ThreadBuffer
+    {
+        int                  threadIndex;
+        std::atomic<quint64> head;
+        Slot                 ring[RING_SIZE];
+    };
+
+    static ThreadBuffer* threadBuffer();
+    static void          append(ThreadBuffer* buffer, const char* name, qint64 start, qint64 duration, int count);
+    static void          write(Slot& slot, const char* name, qint64 start, qint64 duration, int count);
+    static bool          read(const Slot& slot, TraceEvent& event);
+};
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name, bool item = false)
+        : m_name(name),
+          m_item(item),
+          m_start(TraceRecorder::now())
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (m_item)
+            TraceRecorder::recordItem(m_name, m_start, TraceRecorder::now() - m_start);
+        else
+            TraceRecorder::record(m_name, m_start, TraceRecorder::now() - m_start);
+    }
+
+private:
+    const char* m_name;
+    bool        m_item;
+    qint64      m_start;
+};
+
+#endif // TRACERECORDER_H
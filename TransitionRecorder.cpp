@@ -0,0 +1,176 @@
+#include "TransitionRecorder.h"
+#include <QDateTime>
+#include <QDebug>
+
+static const int     FLUSH_INTERVAL = 20;          // ms
+static const quint64 CHUNK_RECORDS  = 1 << 16;     // file growth step, 1 MB
+
+TransitionRecorder::TransitionRecorder(QObject *parent)
+    : QThread{parent},
+      m_head(0),
+      m_tail(0),
+      m_dropped(0),
+      m_rejected(0),
+      m_map(nullptr),
+      m_capacity(0),
+      m_recordCount(0)
+{
+}
+
+TransitionRecorder::~TransitionRecorder()
+{
+    close();
+}
+
+bool TransitionRecorder::open(const QString& fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        qWarning() << "Cannot open transition log" << fileName << m_file.errorString();
+        return false;
+    }
+
+    m_head.store(0);
+    m_tail.store(0);
+    m_dropped.store(0);
+    m_rejected.store(0);
+    m_recordCount = 0;
+    m_capacity = 0;
+
+    if (!growFile())
+    {
+        m_file.close();
+        return false;
+    }
+
+    start(QThread::LowPriority);
+    return true;
+}
+
+void TransitionRecorder::close()
+{
+    if (isRunning())
+    {
+        requestInterruption();
+        wait();
+    }
+
+    if (!m_file.isOpen())
+        return;
+
+    drain();
+
+    // Trim the unused part of the last chunk
+    if (m_map)
+    {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    m_file.resize(sizeof(TransitionLogHeader) + m_recordCount*sizeof(TransitionRecord));
+    m_file.close();
+}
+
+void TransitionRecorder::record(int bcsPosition, int bucketId, quint8 oldState, quint8 newState)
+{
+    // Truncated, it would be replayed on another bucket
+    if (uint(bucketId) > uint(TRANSITION_MAX_BUCKET))
+    {
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const quint64 head = m_head.load(std::memory_order_relaxed);
+
+    // Never block the GUI thread : a full ring drops the event
+    if (head - m_tail.load(std::memory_order_acquire) >= RING_SIZE)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TransitionRecord& record = m_ring[head & (RING_SIZE - 1)];
+    record.timestamp   = QDateTime::currentMSecsSinceEpoch();
+    record.bcsPosition = bcsPosition;
+    record.bucketId    = static_cast<quint16>(bucketId);
+    record.oldState    = oldState;
+    record.newState    = newState;
+
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+void TransitionRecorder::run()
+{
+    while (!isInterruptionRequested())
+    {
+        drain();
+        msleep(FLUSH_INTERVAL);
+    }
+}
+
+void TransitionRecorder::drain()
+{
+    quint64 tail = m_tail.load(std::memory_order_relaxed);
+    const quint64 head = m_head.load(std::memory_order_acquire);
+
+    if (tail == head || !m_map)
+        return;
+
+    TransitionRecord* records = reinterpret_cast<TransitionRecord*>(m_map + sizeof(TransitionLogHeader));
+
+    for (; tail != head; tail++)
+    {
+        if (m_recordCount == m_capacity)
+        {
+            if (!growFile())
+                break;
+            records = reinterpret_cast<TransitionRecord*>(m_map + sizeof(TransitionLogHeader));
+        }
+
+        records[m_recordCount++] = m_ring[tail & (RING_SIZE - 1)];
+    }
+
+    m_tail.store(tail, std::memory_order_release);
+
+    // The count is written last so a reader never sees a partial record
+    if (m_map)
+        reinterpret_cast<TransitionLogHeader*>(m_map)->recordCount = m_recordCount;
+}
+
+bool TransitionRecorder::growFile()
+{
+    if (m_map)
+    {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+
+    const quint64 capacity = m_capacity + CHUNK_RECORDS;
+
+    if (!m_file.resize(sizeof(TransitionLogHeader) + capacity*sizeof(TransitionRecord)))
+    {
+        qWarning() << "Cannot grow transition log" << m_file.errorString();
+        return false;
+    }
+
+    m_map = m_file.map(0, m_file.size());
+
+    if (!m_map)
+    {
+        qWarning() << "Cannot map transition log" << m_file.errorString();
+        return false;
+    }
+
+    m_capacity = capacity;
+
+    TransitionLogHeader* header = reinterpret_cast<TransitionLogHeader*>(m_map);
+    header->magic       = TRANSITION_LOG_MAGIC;
+    header->version     = TRANSITION_LOG_VERSION;
+    header->recordSize  = sizeof(TransitionRecord);
+    header->recordCount = m_recordCount;
+
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef TRANSITIONRECORDER_H
+#define TRANSITIONRECORDER_H
+
+#include <QThread>
+#include <QFile>
+#include <atomic>
+
+// Fixed-size record of one bucket state transition, as stored in the log file
+struct TransitionRecord
+{
+    qint64  timestamp;      // ms since epoch
+    qint32  bcsPosition;
+    quint16 bucketId;
+    quint8  oldState;
+    quint8  newState;
+};
+
+static_assert(sizeof(TransitionRecord) == 16, "TransitionRecord must stay 16 bytes");
+
+// Log file header, followed by recordCount TransitionRecord
+struct TransitionLogHeader
+{
+    quint32 magic;
+    quint16 version;
+    quint16 recordSize;
+    quint64 recordCount;
+};
+
+static const quint32 TRANSITION_LOG_MAGIC   = 0x4C545243;   // "CRTL"
+static const quint16 TRANSITION_LOG_VERSION = 1;
+static const int     TRANSITION_MAX_BUCKET  = 0xFFFF;       // bucketId is 16 bits
+
+//---------------------------------------------------------------------------------------
+// class TransitionRecorder
+// Append-only binary log of the bucket transitions.
+// record() only copies the event into a lock-free single producer ring buffer,
+// the thread drains it into a memory-mapped file grown by chunks.
+//---------------------------------------------------------------------------------------
+
+class TransitionRecorder : public QThread
+{
+    Q_OBJECT
+public:
+    explicit TransitionRecorder(QObject *parent = nullptr);
+    ~TransitionRecorder();
+
+    bool open(const QString& fileName);
+    void close();
+
+    // Hot path, called from the GUI thread on every transition. Ids out of [0, 65535] do not
+    // fit the record and are rejected
+    void record(int bcsPosition, int bucketId, quint8 oldState, quint8 newState);
+
+    quint64 droppedRecords() const { return m_dropped.load(std::memory_order_relaxed); }
+    quint64 rejectedRecords() const { return m_rejected.load(std::memory_order_relaxed); }
+
+protected:
+    void run() override;
+
+private:
+    void drain();
+    bool growFile();
+
+private:
+    static const int RING_SIZE = 1 << 16;
+
+    TransitionRecord        m_ring[RING_SIZE];
+    std::atomic<quint64>    m_head;
+    std::atomic<quint64>    m_tail;
+    std::atomic<quint64>    m_dropped;
+    std::atomic<quint64>    m_rejected;
+
+    QFile                   m_file;
+    uchar*                  m_map;
+    quint64                 m_capacity;
+    quint64                 m_recordCount;
+};
+
+#endif // TRANSITIONRECORDER_H
@@ -0,0 +1,129 @@
+#include "TransitionReplayer.h"
+#include <QDebug>
+
+static const int    REPLAY_INTERVAL = 16;
+static const double MIN_SPEED       = 1.0;
+static const double MAX_SPEED       = 100.0;
+
+TransitionReplayer::TransitionReplayer(CarouselModel* model, QObject *parent)
+    : QObject{parent},
+      m_model(model),
+      m_map(nullptr),
+      m_records(nullptr),
+      m_recordCount(0),
+      m_current(0),
+      m_speed(MIN_SPEED),
+      m_replayOrigin(0),
+      m_timer(new QTimer(this))
+{
+    m_timer->setInterval(REPLAY_INTERVAL);
+    connect(m_timer, &QTimer::timeout, this, &TransitionReplayer::on_timer);
+}
+
+TransitionReplayer::~TransitionReplayer()
+{
+    close();
+}
+
+bool TransitionReplayer::open(const QString& fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+
+    if (!m_file.open(QIODevice::ReadOnly) || m_file.size() < qint64(sizeof(TransitionLogHeader)))
+    {
+        qWarning() << "Cannot open transition log" << fileName;
+        m_file.close();
+        return false;
+    }
+
+    m_map = m_file.map(0, m_file.size());
+
+    if (!m_map)
+    {
+        qWarning() << "Cannot map transition log" << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    const TransitionLogHeader* header = reinterpret_cast<const TransitionLogHeader*>(m_map);
+    const quint64 available = (m_file.size() - sizeof(TransitionLogHeader))/sizeof(TransitionRecord);
+
+    if (header->magic != TRANSITION_LOG_MAGIC || header->version != TRANSITION_LOG_VERSION ||
+        header->recordSize != sizeof(TransitionRecord))
+    {
+        qWarning() << "Invalid transition log" << fileName;
+        close();
+        return false;
+    }
+
+    m_records = reinterpret_cast<const TransitionRecord*>(m_map + sizeof(TransitionLogHeader));
+    m_recordCount = qMin(header->recordCount, available);
+    m_current = 0;
+
+    return true;
+}
+
+void TransitionReplayer::close()
+{
+    stop();
+
+    if (m_map)
+        m_file.unmap(m_map);
+
+    m_map = nullptr;
+    m_records = nullptr;
+    m_recordCount = 0;
+    m_current = 0;
+    m_file.close();
+}
+
+void TransitionReplayer::setSpeed(double speed)
+{
+    // Keep the replay time continuous when the speed changes on the fly
+    if (m_timer->isActive())
+        rebase();
+
+    m_speed = qBound(MIN_SPEED, speed, MAX_SPEED);
+}
+
+void TransitionReplayer::start()
+{
+    if (m_current >= m_recordCount)
+        return;
+
+    m_replayOrigin = m_records[m_current].timestamp;
+    m_clock.start();
+    m_timer->start();
+}
+
+void TransitionReplayer::stop()
+{
+    m_timer->stop();
+}
+
+void TransitionReplayer::rebase()
+{
+    m_replayOrigin += qint64(m_clock.restart()*m_speed);
+}
+
+void TransitionReplayer::on_timer()
+{
+    const qint64 replayTime = m_replayOrigin + qint64(m_clock.elapsed()*m_speed);
+
+    // Records are read straight from the mapping, nothing is loaded in memory
+    while (m_current < m_recordCount && m_records[m_current].timestamp <= replayTime)
+    {
+        const TransitionRecord& record = m_records[m_current++];
+
+        m_model->setPosition(record.bcsPosition);
+        m_model->setState(record.bucketId, static_cast<BucketState>(record.newState));
+    }
+
+    if (m_current >= m_recordCount)
+    {
+        stop();
+        emit finished();
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef TRANSITIONREPLAYER_H
+#define TRANSITIONREPLAYER_H
+
+#include <QObject>
+#include <QFile>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "TransitionRecorder.h"
+#include "CarouselModel.h"
+
+//---------------------------------------------------------------------------------------
+// class TransitionReplayer
+// Feeds a carousel model from a transition log mapped read-only,
+// at 1x to 100x the recorded speed.
+//---------------------------------------------------------------------------------------
+
+class TransitionReplayer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TransitionReplayer(CarouselModel* model, QObject *parent = nullptr);
+    ~TransitionReplayer();
+
+    bool    open(const QString& fileName);
+    void    close();
+
+    quint64 recordCount() const { return m_recordCount; }
+    quint64 currentRecord() const { return m_current; }
+    double  speed() const { return m_speed; }
+
+    void    setSpeed(double speed);
+    void    start();
+    void    stop();
+
+signals:
+    void finished();
+
+private slots:
+    void on_timer();
+
+private:
+    void rebase();
+
+private:
+    CarouselModel*          m_model;
+    QFile                   m_file;
+    uchar*                  m_map;
+    const TransitionRecord* m_records;
+    quint64                 m_recordCount;
+    quint64                 m_current;
+
+    double                  m_speed;
+    qint64                  m_replayOrigin;     // log timestamp matching m_clock start
+    QElapsedTimer           m_clock;
+    QTimer*                 m_timer;
+};
+
+#endif // TRANSITIONREPLAYER_H
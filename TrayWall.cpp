@@ -0,0 +1,328 @@
+#include "TrayWall.h"
+#include "AlarmAnimator.h"
+#include <QPainter>
+#include <QApplication>
+#include <algorithm>
+#include <iterator>
+
+TrayWall::TrayWall(int cellsPerLine, QWidget *parent)
+    : QWidget{parent},
+      m_cellsPerLine(qMax(cellsPerLine, 1)),
+      m_selection(nullptr),
+      m_selectionFill(QColor(0x5E, 0x96, 0xEB)),
+      m_selectionBorder(Qt::transparent),
+      m_selectionBorderThickness(0),
+      m_rubberBand(nullptr),
+      m_pressIndex(-1)
+{
+}
+
+TrayWall::~TrayWall()
+{
+    if (!m_alarms.isEmpty())
+        AlarmAnimator::instance()->removeView(this);
+}
+
+// The selection must have one bit per cell, it is not owned
+void TrayWall::setSelectionModel(SelectionModel* selection)
+{
+    if (selection == m_selection || (selection && selection->size() != cellCount()))
+        return;
+
+    if (m_selection)
+        disconnect(m_selection, nullptr, this, nullptr);
+
+    m_selection = selection;
+
+    if (m_selection)
+        connect(m_selection, &SelectionModel::selectionChanged, this, &TrayWall::on_selectionChanged);
+
+    update();
+}
+
+bool TrayWall::isAlarmed(int index) const
+{
+    return std::binary_search(m_alarms.cbegin(), m_alarms.cend(), index);
+}
+
+void TrayWall::setAlarmed(int index, bool alarmed)
+{
+    if (index < 0 || index >= cellCount())
+        return;
+
+    auto it = std::lower_bound(m_alarms.begin(), m_alarms.end(), index);
+    const bool present = it != m_alarms.end() && *it == index;
+
+    if (present == alarmed)
+        return;
+
+    const bool wasEmpty = m_alarms.isEmpty();
+
+    if (alarmed)
+        m_alarms.insert(it, index);
+    else
+        m_alarms.erase(it);
+
+    registerAlarms(wasEmpty);
+    update(cellRect(index));
+}
+
+// Merge of the cells before, the range and the cells after, in one pass
+void TrayWall::setAlarmedRange(int first, int last, const AlarmPredicate& alarmed)
+{
+    first = qMax(first, 0);
+    last  = qMin(last, cellCount() - 1);
+
+    if (first > last)
+        return;
+
+    const bool wasEmpty = m_alarms.isEmpty();
+    auto it = std::lower_bound(m_alarms.cbegin(), m_alarms.cend(), first);
+    int changedFirst = -1;
+    int changedLast = -1;
+
+    m_alarmsBuffer.clear();
+    m_alarmsBuffer.reserve(m_alarms.size() + last - first + 1);
+    std::copy(m_alarms.cbegin(), it, std::back_inserter(m_alarmsBuffer));
+
+    for (int index = first; index <= last; index++)
+    {
+        const bool present = it != m_alarms.cend() && *it == index;
+        const bool now = alarmed(index);
+
+        if (present)
+            ++it;
+
+        if (now)
+            m_alarmsBuffer.append(index);
+
+        if (now != present)
+        {
+            if (changedFirst < 0)
+                changedFirst = index;
+            changedLast = index;
+        }
+    }
+
+    if (changedFirst < 0)
+        return;
+
+    std::copy(it, m_alarms.cend(), std::back_inserter(m_alarmsBuffer));
+    m_alarms.swap(m_alarmsBuffer);
+
+    registerAlarms(wasEmpty);
+    updateRange(changedFirst, changedLast);
+}
+
+// Registered with the shared clock only while something blinks
+void TrayWall::registerAlarms(bool wasEmpty)
+{
+    if (wasEmpty && !m_alarms.isEmpty())
+    {
+        AlarmAnimator::instance()->addView(this);
+        connect(AlarmAnimator::instance(), &AlarmAnimator::phaseChanged, this, &TrayWall::on_alarmPhaseChanged);
+    }
+    else if (!wasEmpty && m_alarms.isEmpty())
+    {
+        AlarmAnimator::instance()->removeView(this);
+        disconnect(AlarmAnimator::instance(), nullptr, this, nullptr);
+    }
+}
+
+// Only the alarmed cells are invalidated at each phase
+void TrayWall::on_alarmPhaseChanged(bool on)
+{
+    Q_UNUSED(on);
+
+    QRegion region;
+
+    for (int index : qAsConst(m_alarms))
+        region += cellRect(index);
+
+    update(region);
+}
+
+void TrayWall::paintAlarms(QPainter& painter, const QRect& dirty) const
+{
+    int firstLine, lastLine, firstCell, lastCell;
+
+    if (m_alarms.isEmpty() || !AlarmAnimator::instance()->isOn() ||
+        !cellsIn(dirty, firstLine, lastLine, firstCell, lastCell))
+        return;
+
+    for (int line = firstLine; line <= lastLine; line++)
+    {
+        const int last = line*m_cellsPerLine + lastCell;
+
+        for (auto it = std::lower_bound(m_alarms.cbegin(), m_alarms.cend(), line*m_cellsPerLine + firstCell);
+             it != m_alarms.cend() && *it <= last; ++it)
+            painter.fillRect(cellRect(*it), ALARM_BLINK_COLOR);
+    }
+}
+
+void TrayWall::setSelectionStyle(const QColor& fill, const QColor& border, int borderThickness)
+{
+    m_selectionFill = fill;
+    m_selectionBorder = border;
+    m_selectionBorderThickness = borderThickness;
+}
+
+// Same rounding as the carousel lines : the first cells get the remaining pixels
+QRect TrayWall::rangeRect(int line, int first, int last) const
+{
+    const int cellWidth = width()/m_cellsPerLine;
+    const int nb_oversizeCells = width() - cellWidth*m_cellsPerLine;
+    const int lineHeight = height()/TRAY_WALL_LINES;
+
+    const int x0 = first*cellWidth + qMin(first, nb_oversizeCells);
+    const int x1 = (last + 1)*cellWidth + qMin(last + 1, nb_oversizeCells);
+
+    return QRect(x0, line*lineHeight, x1 - x0, lineHeight);
+}
+
+QRect TrayWall::cellRect(int index) const
+{
+    const int line = index/m_cellsPerLine;
+    const int cell = index % m_cellsPerLine;
+
+    return rangeRect(line, cell, cell);
+}
+
+// Inverse of rangeRect : the oversized cells come first
+int TrayWall::cellAtX(int x) const
+{
+    const int cellWidth = width()/m_cellsPerLine;
+    const int nb_oversizeCells = width() - cellWidth*m_cellsPerLine;
+    const int oversizeWidth = nb_oversizeCells*(cellWidth + 1);
+
+    if (x < oversizeWidth)
+        return x/(cellWidth + 1);
+
+    if (cellWidth == 0)
+        return m_cellsPerLine - 1;
+
+    return qMin(nb_oversizeCells + (x - oversizeWidth)/cellWidth, m_cellsPerLine - 1);
+}
+
+int TrayWall::indexAt(const QPoint& pos) const
+{
+    const int lineHeight = height()/TRAY_WALL_LINES;
+
+    if (lineHeight <= 0 || !rect().contains(pos) || pos.y() >= TRAY_WALL_LINES*lineHeight)
+        return -1;
+
+    return (pos.y()/lineHeight)*m_cellsPerLine + cellAtX(pos.x());
+}
+
+bool TrayWall::cellsIn(const QRect& rect, int& firstLine, int& lastLine, int& firstCell, int& lastCell) const
+{
+    const int lineHeight = height()/TRAY_WALL_LINES;
+    const QRect area = rect & QRect(0, 0, width(), TRAY_WALL_LINES*lineHeight);
+
+    if (lineHeight <= 0 || area.isEmpty())
+        return false;
+
+    firstLine = area.top()/lineHeight;
+    lastLine  = qMin(area.bottom()/lineHeight, TRAY_WALL_LINES - 1);
+    firstCell = cellAtX(area.left());
+    lastCell  = cellAtX(area.right());
+
+    return true;
+}
+
+void TrayWall::paintSelection(QPainter& painter, const QRect& dirty) const
+{
+    int firstLine, lastLine, firstCell, lastCell;
+
+    if (!m_selection || !cellsIn(dirty, firstLine, lastLine, firstCell, lastCell))
+        return;
+
+    painter.save();
+
+    if (m_selectionBorderThickness > 0)
+        painter.setPen(QPen(m_selectionBorder, m_selectionBorderThickness, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin));
+    else
+        painter.setPen(Qt::NoPen);
+
+    const int inset = m_selectionBorderThickness/2;
+
+    // Only the set bits are visited
+    for (int line = firstLine; line <= lastLine; line++)
+    {
+        const int last = line*m_cellsPerLine + lastCell;
+
+        for (int index = m_selection->nextSelected(line*m_cellsPerLine + firstCell);
+             index >= 0 && index <= last;
+             index = m_selection->nextSelected(index + 1))
+        {
+            const QRect cell = cellRect(index);
+            painter.fillRect(cell, m_selectionFill);
+
+            if (m_selectionBorderThickness > 0)
+                painter.drawRect(cell.adjusted(inset, inset, -inset - 1, -inset - 1));
+        }
+    }
+
+    painter.restore();
+}
+
+void TrayWall::on_selectionChanged(int first, int last)
+{
+    updateRange(first, last);
+}
+
+void TrayWall::updateRange(int first, int last)
+{
+    const int firstLine = first/m_cellsPerLine;
+    const int lastLine = last/m_cellsPerLine;
+
+    if (firstLine == lastLine)
+        update(rangeRect(firstLine, first % m_cellsPerLine, last % m_cellsPerLine));
+    else
+        update(rangeRect(firstLine, 0, m_cellsPerLine - 1) | rangeRect(lastLine, 0, m_cellsPerLine - 1));
+}
+
+void TrayWall::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton)
+        return QWidget::mousePressEvent(event);
+
+    m_pressPos = event->pos();
+    m_pressIndex = indexAt(event->pos());
+}
+
+void TrayWall::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!(event->buttons() & Qt::LeftButton) || !m_selection)
+        return QWidget::mouseMoveEvent(event);
+
+    if (!m_rubberBand)
+        m_rubberBand = new QRubberBand(QRubberBand::Rectangle, this);
+
+    if ((event->pos() - m_pressPos).manhattanLength() < QApplication::startDragDistance())
+        return;
+
+    m_rubberBand->setGeometry(QRect(m_pressPos, event->pos()).normalized());
+    m_rubberBand->show();
+}
+
+void TrayWall::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || !m_selection)
+        return QWidget::mouseReleaseEvent(event);
+
+    if (m_rubberBand && m_rubberBand->isVisible())
+    {
+        int firstLine, lastLine, firstCell, lastCell;
+        const bool extend = event->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier);
+
+        if (cellsIn(m_rubberBand->geometry(), firstLine, lastLine, firstCell, lastCell))
+            m_selection->selectBlock(firstLine, lastLine, firstCell, lastCell, m_cellsPerLine, extend);
+
+        m_rubberBand->hide();
+    }
+    else if (m_pressIndex >= 0)
+        m_selection->click(m_pressIndex, event->modifiers());
+
+    m_pressIndex = -1;
+}
@@ -0,0 +1,90 @@
+#ifndef TRAYWALL_H
+#define TRAYWALL_H
+
+#include <QWidget>
+#include <QMouseEvent>
+#include <QRubberBand>
+#include <functional>
+#include "ConveyorModel.h"
+#include "SelectionModel.h"
+
+//---------------------------------------------------------------------------------------
+// class TrayWall
+// Grid shared by the output and container walls : four lines (UB, UF, LB, LF) of the same
+// number of cells, stored line after line. Handles the cell geometry, click and rubber
+// band selection, and paints the selection as an overlay over the cells.
+//---------------------------------------------------------------------------------------
+
+static const int TRAY_WALL_LINES = CONVEYOR_TRAY_LINES;
+
+class TrayWall : public QWidget
+{
+    Q_OBJECT
+public:
+    int cellsPerLine() const { return m_cellsPerLine; }
+    int cellCount() const { return TRAY_WALL_LINES*m_cellsPerLine; }
+
+    // Row of a level and side in the wall, as in ConveyorModel
+    static int lineOf(ConveyorLevel level, ConveyorSide side) { return ConveyorModel::lineOf(level, side); }
+
+    // Cell under a point of the widget, -1 if none
+    int indexAt(const QPoint& pos) const;
+
+    SelectionModel* selectionModel() const { return m_selection; }
+    void            setSelectionModel(SelectionModel* selection);
+
+    typedef std::function<bool(int index)> AlarmPredicate;
+
+    // Alarmed cells blink with the shared AlarmAnimator clock
+    bool isAlarmed(int index) const;
+    void setAlarmed(int index, bool alarmed);
+
+    // Cells [first, last] alarmed where the predicate holds : the index is rebuilt once and
+    // only the changed span is repainted
+    void setAlarmedRange(int first, int last, const AlarmPredicate& alarmed);
+
+protected:
+    TrayWall(int cellsPerLine, QWidget *parent);
+    ~TrayWall();
+
+    QRect cellRect(int index) const;
+    QRect rangeRect(int line, int first, int last) const;
+
+    // Repaints the cells [first, last] of the whole wall, over several lines if needed
+    void  updateRange(int first, int last);
+
+    // Lines and cells intersecting a rectangle, false if none
+    bool cellsIn(const QRect& rect, int& firstLine, int& lastLine, int& firstCell, int& lastCell) const;
+
+    void setSelectionStyle(const QColor& fill, const QColor& border, int borderThickness);
+    void paintSelection(QPainter& painter, const QRect& dirty) const;
+    void paintAlarms(QPainter& painter, const QRect& dirty) const;
+
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+
+private slots:
+    void on_selectionChanged(int first, int last);
+    void on_alarmPhaseChanged(bool on);
+
+private:
+    int  cellAtX(int x) const;
+    void registerAlarms(bool wasEmpty);
+
+private:
+    int             m_cellsPerLine;
+    SelectionModel* m_selection;
+    QColor          m_selectionFill;
+    QColor          m_selectionBorder;
+    int             m_selectionBorderThickness;
+
+    QVector<int>    m_alarms;           // sorted cell indices
+    QVector<int>    m_alarmsBuffer;     // rebuilt index, swapped with m_alarms
+
+    QRubberBand*    m_rubberBand;
+    QPoint          m_pressPos;
+    int             m_pressIndex;
+};
+
+#endif // TRAYWALL_H
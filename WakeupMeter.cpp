@@ -0,0 +1,73 @@
+#include "WakeupMeter.h"
+#include "FrameScheduler.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QTextStream>
+#include <QDebug>
+
+WakeupMeter::WakeupMeter(CarouselModel* model, const QString& fileName, QObject *parent)
+    : QObject{parent},
+      m_model(model),
+      m_timer(new QTimer(this)),
+      m_file(fileName),
+      m_timerEvents(0),
+      m_lastFrames(FrameScheduler::wakeupCount()),
+      m_lastTransitions(model->transitionCount()),
+      m_lastPosition(model->position())
+{
+    // Application filters see every event of the GUI thread before its receiver
+    QCoreApplication::instance()->installEventFilter(this);
+
+    m_timer->setInterval(WAKEUP_LOG_PERIOD);
+    connect(m_timer, &QTimer::timeout, this, &WakeupMeter::on_period);
+    m_timer->start();
+    m_clock.start();
+    m_runningClock.start();
+
+    if (!fileName.isEmpty())
+    {
+        if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+            m_file.write("seconds,mode,timers_per_s,frames_per_s\n");
+        else
+            qWarning() << "Cannot write the wakeups to" << fileName;
+    }
+}
+
+WakeupMeter::~WakeupMeter()
+{
+    QCoreApplication::instance()->removeEventFilter(this);
+}
+
+bool WakeupMeter::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Timer)
+        m_timerEvents++;
+
+    return QObject::eventFilter(watched, event);
+}
+
+void WakeupMeter::on_period()
+{
+    const double seconds = m_clock.restart()/1000.0;
+    const quint64 frames = FrameScheduler::wakeupCount();
+    const bool moving = m_model->transitionCount() != m_lastTransitions || m_model->position() != m_lastPosition;
+
+    const double timerRate = m_timerEvents/seconds;
+    const double frameRate = (frames - m_lastFrames)/seconds;
+
+    if (m_file.isOpen())
+    {
+        QTextStream out(&m_file);
+        out << m_runningClock.elapsed()/1000.0 << "," << (moving ? "moving" : "stopped") << ","
+            << timerRate << "," << frameRate << "\n";
+        out.flush();
+    }
+    else
+        qDebug().nospace() << "Wakeups/s (" << (moving ? "moving" : "stopped") << ") timers: "
+                           << timerRate << " frames: " << frameRate;
+
+    m_timerEvents = 0;
+    m_lastFrames = frames;
+    m_lastTransitions = m_model->transitionCount();
+    m_lastPosition = m_model->position();
+}
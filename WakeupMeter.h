@@ -0,0 +1,47 @@
+#ifndef WAKEUPMETER_H
+#define WAKEUPMETER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFile>
+#include "CarouselModel.h"
+
+//---------------------------------------------------------------------------------------
+// class WakeupMeter
+// Counts the timer events delivered on the GUI thread and the frames of the schedulers,
+// and records their rate per second, tagged "moving" or "stopped" depending on the model
+// activity during the period : one CSV line per period in the file given, or the debug
+// log without file. The meter itself adds one wakeup per period.
+//---------------------------------------------------------------------------------------
+
+static const int WAKEUP_LOG_PERIOD = 5000;      // ms
+
+class WakeupMeter : public QObject
+{
+    Q_OBJECT
+public:
+    WakeupMeter(CarouselModel* model, const QString& fileName, QObject *parent = nullptr);
+    ~WakeupMeter();
+
+    void setPeriod(int ms) { m_timer->setInterval(ms); }
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void on_period();
+
+private:
+    CarouselModel*  m_model;
+    QTimer*         m_timer;
+    QElapsedTimer   m_clock;
+    QElapsedTimer   m_runningClock;
+    QFile           m_file;
+    quint64         m_timerEvents;
+    quint64         m_lastFrames;
+    quint64         m_lastTransitions;
+    int             m_lastPosition;
+};
+
+#endif // WAKEUPMETER_H
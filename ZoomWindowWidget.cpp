@@ -0,0 +1,112 @@
+#include "ZoomWindowWidget.h"
+#include "PaintProfiler.h"
+#include "LabelCache.h"
+#include <QPainter>
+
+ZoomWindowWidget::ZoomWindowWidget(CarouselModel* model, QWidget *parent)
+    : QWidget{parent},
+      m_model(model),
+      m_first(0),
+      m_last(-1),
+      m_fontSize(10),
+      m_borderThickness(2)
+{
+    setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    connect(m_model, &CarouselModel::bucketsChanged, this, &ZoomWindowWidget::on_bucketsChanged);
+}
+
+void ZoomWindowWidget::setWindow(int first, int last)
+{
+    first = qMax(first, 0);
+    last  = qMin(last, m_model->bucketCount() - 1);
+
+    if (first == m_first && last == m_last)
+        return;
+
+    m_first = first;
+    m_last = last;
+
+    renderCells();
+}
+
+void ZoomWindowWidget::on_bucketsChanged(int first, int last)
+{
+    // Changes outside the magnified range do not concern this view
+    if (last < m_first || first > m_last)
+        return;
+
+    renderCells();
+}
+
+void ZoomWindowWidget::resizeEvent(QResizeEvent *event)
+{
+    Q_UNUSED(event);
+    renderCells();
+}
+
+// Only the cells of the window are drawn, so the cost does not depend on the bucket count
+void ZoomWindowWidget::renderCells()
+{
+    if (width() <= 0 || height() <= 0)
+        return;
+
+    if (m_image.size() != size())
+        m_image = QImage(size(), QImage::Format_ARGB32_Premultiplied);
+
+    m_image.fill(palette().window().color());
+
+    const int nbCells = m_last - m_first + 1;
+
+    if (nbCells > 0)
+    {
+        QPainter painter(&m_image);
+        painter.setPen(QPen(QColor("#000"), m_borderThickness, Qt::SolidLine, Qt::SquareCap, Qt::MiterJoin));
+        painter.setFont(QFont("Arial", m_fontSize, QFont::Normal));
+
+        // Same rounding as the carousel lines : the first cells get the remaining pixels
+        const int cellWidth = width()/nbCells;
+        int nb_oversizeCells = width() - cellWidth*nbCells;
+        int x = 0;
+
+        // Ids are visited in order, each lockout check is amortised O(1)
+        IntervalSet::Cursor disabled(m_model->disabledRanges());
+        const QBrush lockout(QColor("#000"), Qt::BDiagPattern);
+
+        for (int i = 0; i < nbCells; i++)
+        {
+            int w = cellWidth;
+
+            if (nb_oversizeCells > 0)
+            {
+                w++;
+                nb_oversizeCells--;
+            }
+
+            const int id = m_first + i;
+            QRect cell(x, 0, w, height());
+
+            painter.fillRect(cell, BucketPlate::stateColor(m_model->state(id)));
+
+            if (disabled.contains(id))
+                painter.fillRect(cell, lockout);
+            painter.drawRect(cell.adjusted(m_borderThickness/2, m_borderThickness/2,
+                                           -m_borderThickness/2, -m_borderThickness/2));
+            painter.drawText(cell, Qt::AlignCenter, LabelCache::number(id));
+
+            x += w;
+        }
+
+        painter.end();
+    }
+
+    update();
+}
+
+void ZoomWindowWidget::paintEvent(QPaintEvent *event)
+{
+    PAINT_PROFILE("ZoomWindowWidget", event->rect());
+    QPainter painter(this);
+    painter.drawImage(event->rect(), m_image, event->rect());
+}
@@ -0,0 +1,45 @@
+#ifndef ZOOMWINDOWWIDGET_H
+#define ZOOMWINDOWWIDGET_H
+
+#include <QWidget>
+#include <QImage>
+#include "CarouselModel.h"
+
+//---------------------------------------------------------------------------------------
+// class ZoomWindowWidget
+// Magnified strip of the buckets under the zoom handle, drawn with the ZoomLineWidget look.
+// The cells are painted from the carousel model into one image, no widget per bucket.
+//---------------------------------------------------------------------------------------
+
+class ZoomWindowWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit ZoomWindowWidget(CarouselModel* model, QWidget *parent = nullptr);
+
+    int  first() const { return m_first; }
+    int  last() const { return m_last; }
+
+    void setWindow(int first, int last);
+    void setFontSize(int fontSize){ m_fontSize = fontSize; };
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void on_bucketsChanged(int first, int last);
+
+private:
+    void renderCells();
+
+private:
+    CarouselModel*  m_model;
+    int             m_first;
+    int             m_last;
+    int             m_fontSize;
+    int             m_borderThickness;
+    QImage          m_image;
+};
+
+#endif // ZOOMWINDOWWIDGET_H
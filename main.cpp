@@ -1,10 +1,113 @@
 #include "MainWindow.h"
+#include "SharedBucketChannel.h"
+#include "StatePalette.h"
+#include "CarouselDashboard.h"
+#include "SorterSimulator.h"
 
 #include <QApplication>
+#include <QThread>
+#include <QDebug>
+#include <random>
+#include <csignal>
+
+static volatile std::sig_atomic_t s_writerStopped = 0;
+
+static void stopGatewayWriter(int) { s_writerStopped = 1; }
+
+// Stand-in for the PLC gateway : publishes random transitions in the shared bucket segment
+// Usage : Carousel --gateway-writer [nbBuckets] [updatesPerSecond]
+// Runs until SIGINT or SIGTERM, the segment is unlinked on the way out
+static int runGatewayWriter(int argc, char *argv[])
+{
+    const int nbBuckets = argc > 2 ? atoi(argv[2]) : 2000;
+    const int rate      = argc > 3 ? atoi(argv[3]) : 50;
+
+    SharedBucketWriter writer;
+
+    if (nbBuckets <= 0 || rate <= 0 || !writer.create(SHARED_BUCKET_DEFAULT_NAME, nbBuckets))
+        return 1;
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> bucket(0, nbBuckets - 1);
+    std::uniform_int_distribution<int> state(0, static_cast<int>(BucketState::FAILURE));
+
+    QVector<quint8> states(nbBuckets, static_cast<quint8>(BucketState::EMPTY));
+    int bcsPosition = 0;
+
+    std::signal(SIGINT, stopGatewayWriter);
+    std::signal(SIGTERM, stopGatewayWriter);
+
+    while (!s_writerStopped)
+    {
+        for (int i = 0; i < nbBuckets/100 + 1; i++)
+            states[bucket(generator)] = quint8(state(generator));
+
+        writer.publish(states.constData(), ++bcsPosition);
+        QThread::usleep(1000000/rate);
+    }
+
+    writer.close();
+    return 0;
+}
+
+// Positional number, the default when missing or followed by an option (--theme)
+static int numberArgument(int argc, char *argv[], int index, int defaultValue)
+{
+    bool isNumber = false;
+    const int value = index < argc ? QByteArray(argv[index]).toInt(&isNumber) : 0;
+
+    return isNumber ? value : defaultValue;
+}
+
+// Control room view : simulated sorters sharing one dashboard, one frame clock and one render pool
+// Usage : Carousel --dashboard [nbCarousels] [nbBuckets]
+static int runDashboard(QApplication& application, int argc, char *argv[])
+{
+    const int nbCarousels = numberArgument(argc, argv, 2, 6);
+    const int nbBuckets   = numberArgument(argc, argv, 3, 800);
+
+    if (nbCarousels <= 0 || nbBuckets <= 1)
+        return 1;
+
+    CarouselDashboard dashboard;
+    dashboard.setWindowTitle("Carousel dashboard");
+    dashboard.resize(1600, 900);
+
+    for (int i = 0; i < nbCarousels; i++)
+    {
+        SorterSimulatorConfig config;
+        config.seed = quint32(i + 1);
+        config.bucketCount = nbBuckets;
+        config.levels = ConveyorLevel::UPPER;
+
+        SorterSimulator* simulator = new SorterSimulator(config, &dashboard);
+        dashboard.addCarousel(simulator->model(ConveyorLevel::UPPER), QString("Sorter %1").arg(i + 1));
+        simulator->start();
+    }
+
+    dashboard.show();
+    return application.exec();
+}
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && qstrcmp(argv[1], "--gateway-writer") == 0)
+        return runGatewayWriter(argc, argv);
+
     QApplication a(argc, argv);
+
+    // State colours of the site, read once before any view is created, the dashboard included
+    // Usage : Carousel [--dashboard ...] --theme theme.json
+    const QStringList arguments = QCoreApplication::arguments();
+    const int themeArgument = arguments.indexOf("--theme");
+
+    if (themeArgument > 0 && themeArgument + 1 < arguments.size() &&
+        !StatePalette::loadTheme(arguments.at(themeArgument + 1)))
+        qWarning() << "Cannot load the theme" << arguments.at(themeArgument + 1);
+
+    if (argc > 1 && qstrcmp(argv[1], "--dashboard") == 0)
+        return runDashboard(a, argc, argv);
+
     MainWindow w;
     w.show();
     return a.exec();
@@ -0,0 +1,6 @@
+TARGET = tst_allocations
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_allocations.cpp
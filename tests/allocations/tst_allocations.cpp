@@ -0,0 +1,163 @@
+#include <QtTest>
+#include <QApplication>
+#include <atomic>
+#include "BasicCarousel.h"
+#include "AlarmAnimator.h"
+
+static const int TICK_BUCKETS   = 600;
+static const int MEASURED_TICKS = 200;
+
+//---------------------------------------------------------------------------------------
+// Heap allocations counted by interposing malloc, calloc and realloc (glibc only) : the
+// definitions of the executable take precedence over the C library for Qt as well.
+//---------------------------------------------------------------------------------------
+
+static std::atomic<bool> s_counting(false);
+static std::atomic<int>  s_allocations(0);
+
+#ifdef __GLIBC__
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+void* malloc(size_t size)
+{
+    if (s_counting.load(std::memory_order_relaxed))
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    if (s_counting.load(std::memory_order_relaxed))
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size)
+{
+    if (s_counting.load(std::memory_order_relaxed))
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    return __libc_realloc(pointer, size);
+}
+}
+#endif
+
+// Allocations made by a piece of code, nothing else must run meanwhile
+template<typename Code>
+static int allocationsOf(Code code)
+{
+    s_allocations.store(0);
+    s_counting.store(true);
+    code();
+    s_counting.store(false);
+    return s_allocations.load();
+}
+
+//---------------------------------------------------------------------------------------
+// class AllocationsTest
+// Steady-state ticks must not touch the heap : once the caches (labels, alarm array) are
+// warm, a rotation only moves indices and shared strings around.
+//---------------------------------------------------------------------------------------
+
+class AllocationsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void rotationTick();
+    void alarmToggle();
+};
+
+void AllocationsTest::initTestCase()
+{
+#ifndef __GLIBC__
+    QSKIP("malloc interposition needs glibc");
+#endif
+    QVERIFY(allocationsOf([]() { delete new int(0); }) > 0);
+}
+
+// Every state passes by every slot, the hatched and disabled ones included
+void AllocationsTest::rotationTick()
+{
+    BasicCarousel carousel(QRect(0, 0, 1900, 150), TICK_BUCKETS);
+    CarouselModel* model = carousel.model();
+
+    const BucketState pattern[] = { BucketState::EMPTY, BucketState::SORTED, BucketState::FAILURE, BucketState::UNKNOWN,
+                                    BucketState::INJECTED, BucketState::REJECTED, BucketState::DISABLED,
+                                    BucketState::EMPTY, BucketState::SORTED };
+    const int patternSize = int(sizeof(pattern)/sizeof(pattern[0]));
+    QVector<quint8> states(TICK_BUCKETS);
+
+    for (int id = 0; id < TICK_BUCKETS; id++)
+        states[id] = static_cast<quint8>(pattern[(id*5 + id/3) % patternSize]);
+
+    model->setStates(states, 0);
+
+    // A whole turn first : every slot has shown every bucket, the alarm array is at its size
+    for (int tick = 0; tick < TICK_BUCKETS; tick++)
+        model->setPosition(model->position() + 1);
+
+    QVERIFY(AlarmAnimator::instance()->alarmCount() > 0);
+
+    const int allocations = allocationsOf([model]()
+    {
+        for (int tick = 0; tick < MEASURED_TICKS; tick++)
+            model->setPosition(model->position() + 1);
+    });
+
+    QCOMPARE(allocations, 0);
+}
+
+// Alarms raised and cleared in any order once the array has grown
+void AllocationsTest::alarmToggle()
+{
+    QWidget parent;
+    QVector<BucketPlate*> plates;
+
+    for (int i = 0; i < TICK_BUCKETS; i++)
+        plates.append(new BucketPlate(&parent));
+
+    for (BucketPlate* plate : qAsConst(plates))
+        plate->setAlarmed(true);
+
+    for (BucketPlate* plate : qAsConst(plates))
+        plate->setAlarmed(false);
+
+    // Keeps the blink clock running : starting a timer registers it, which allocates
+    BucketPlate sentinel(&parent);
+    sentinel.setAlarmed(true);
+
+    const int allocations = allocationsOf([&plates]()
+    {
+        for (int round = 0; round < 10; round++)
+        {
+            for (int i = 0; i < TICK_BUCKETS; i++)
+                plates[(i*7 + round) % TICK_BUCKETS]->setAlarmed(i % 3 != 0);
+
+            for (int i = TICK_BUCKETS - 1; i >= 0; i--)
+                plates[i]->setAlarmed(false);
+        }
+    });
+
+    QCOMPARE(allocations, 0);
+}
+
+// Widgets are created but never shown : no display is needed
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication application(argc, argv);
+    AllocationsTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_allocations.moc"
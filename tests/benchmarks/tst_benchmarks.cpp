@@ -0,0 +1,1012 @@
+#include <QtTest>
+#include <QApplication>
+#include <QImage>
+#include "CarouselModel.h"
+#include "BasicCarousel.h"
+#include "ConveyorModel.h"
+#include "OutputWall.h"
+#include "BucketClickDispatcher.h"
+#include "StatePalette.h"
+#include "CarouselDashboard.h"
+#include "WakeupMeter.h"
+#include "StallWatchdog.h"
+#include "SharedBucketChannel.h"
+#include "TransitionRecorder.h"
+#include "CarouselHistory.h"
+#include "SynopticExporter.h"
+#include "ConveyorSnapshot.h"
+#include "TelegramDecoder.h"
+#include "PaintProfiler.h"
+#include "SelectionModel.h"
+#include <QtEndian>
+#include <ctime>
+#include <limits>
+#include <random>
+
+static const int LOOKUP_BUCKETS = 10000;
+static const int WALL_OUTPUTS   = 500;         // per line, four lines
+static const int INHIBIT_FIRST  = 40;
+static const int INHIBIT_LAST   = 120;
+static const int CLICK_BUCKETS  = 2000;
+static const int STATE_TRAYS    = 2000;
+
+static const int DASHBOARD_CAROUSELS = 6;
+static const int DASHBOARD_BUCKETS   = 800;
+static const int DASHBOARD_RATE      = 20;     // updates per second of every sorter
+static const int DASHBOARD_SECONDS   = 5;
+
+static const int GATEWAY_BUCKETS = 2000;
+
+static const int    HISTORY_BUCKETS     = 2000;
+static const qint64 HISTORY_SHIFT       = 8*3600*1000;     // ms, the default retention
+static const int    HISTORY_STEP        = 100;             // ms, one rotation step and a few transitions
+static const int    HISTORY_TRANSITIONS = 5;
+static const qint64 HISTORY_BUDGET      = 64*1024*1024;    // CarouselHistory default
+
+static const int    EXPORT_FRAMES = 100;       // at EXPORT_WIDTH, the target is 100 frames/s
+static const qint64 EXPORT_STEP   = 1000;      // ms between two frames, as the F10 shift report
+
+static const int TELEGRAM_BUCKETS = 2000;
+static const int TELEGRAM_FRAMES  = 5000;      // full telegrams of the capture
+
+static const int PROFILER_FRAMES = 50;
+static const int PROFILER_BUDGET = 50;         // the scopes stay under 1/50 of the frame time
+
+static const int SELECTION_ITEMS = 10000;      // range selection in microseconds
+
+static const int RESTORE_BUCKETS = 10000;      // the restore target is a few ms
+
+static const int RECORD_EVENTS = 32768;        // half the ring : never full, even without drain
+static const int RECORD_PASSES = 5;
+
+static const int PROPAGATION_BUCKETS = 500;
+static const int PROPAGATION_VIEWS   = 3;
+
+static const int WAKEUP_BUCKETS  = 600;
+static const int WAKEUP_PERIOD   = 500;        // ms
+static const int WAKEUP_PHASE    = 3000;       // ms, moving then stopped
+static const int WAKEUP_SETTLE   = 3000;       // ms, longer than the idle delay of the watchdog
+
+// OutputTray::setState before the packed tables : colour parsed from its hex string and
+// style sheet concatenated at every call
+static void legacyOutputStyle(OutputTrayState state, bool isLast, QColor& color, QString& styleSheet)
+{
+    switch (state)
+    {
+    case OutputTrayState::ENABLED:        color = QColor("#E1F4FF"); break;
+    case OutputTrayState::INHIBITED_U:    color = QColor("#8282C4"); break;
+    case OutputTrayState::INHIBITED_PATD: color = QColor("#6DADAD"); break;
+    case OutputTrayState::INHIBITED_SD:   color = QColor("#B88C5A"); break;
+    default:                              color = QColor(0, 0, 0, 0);
+    }
+
+    styleSheet = "border:1px solid black; ";
+
+    if (!isLast)
+        styleSheet += "border-right:0;";
+}
+
+static const QString TABLE_STYLE = "border:1px solid black; border-right:0;";
+
+static QString parcelName(int id) { return QString("P%1").arg(id, 6, 10, QLatin1Char('0')); }
+
+//---------------------------------------------------------------------------------------
+// class BenchmarksTest
+// Timings of the hot paths at production sizes, run with -tickcounter or -callgrind for
+// stable numbers. The widgets are not shown, except for the frames of resizeDrag.
+//---------------------------------------------------------------------------------------
+
+class BenchmarksTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parcelLookup_data();
+    void parcelLookup();
+    void highlightParcel();
+    void bulkInhibition();
+    void trayInhibition();
+    void clickWiring_data();
+    void clickWiring();
+    void constructCarousel();
+    void destroyCarousel();
+    void resizeDrag();
+    void stateStyle_data();
+    void stateStyle();
+    void setStateThroughput();
+    void dashboardLoad();
+    void idleWakeups();
+    void propagation();
+    void conveyorMasks();
+    void gatewayLatency_data();
+    void gatewayLatency();
+    void transitionRecord();
+    void historySeek();
+    void exportSynoptics();
+    void snapshotRoundTrip();
+    void telegramCapture();
+    void paintProfiler_data();
+    void paintProfiler();
+    void rangeSelection();
+};
+
+void BenchmarksTest::parcelLookup_data()
+{
+    QTest::addColumn<int>("rotationHz");
+
+    QTest::newRow("1 Hz")  << 1;
+    QTest::newRow("10 Hz") << 10;
+    QTest::newRow("50 Hz") << 50;
+}
+
+// One iteration is one second of rotation with one barcode lookup per tick
+void BenchmarksTest::parcelLookup()
+{
+    QFETCH(int, rotationHz);
+
+    CarouselModel model(LOOKUP_BUCKETS);
+    QVector<QString> parcels;
+
+    for (int id = 0; id < LOOKUP_BUCKETS; id++)
+    {
+        parcels.append(parcelName(id));
+        model.assignParcel(parcels.last(), id);
+    }
+
+    int parcel = 0;
+    int id = 0;
+    int slot = 0;
+
+    QBENCHMARK
+    {
+        for (int tick = 0; tick < rotationHz; tick++)
+        {
+            model.setPosition(model.position() + 1);
+
+            id = model.bucketOfParcel(parcels[parcel]);
+            slot = model.slotOf(id);
+            parcel = (parcel + 7919) % LOOKUP_BUCKETS;
+        }
+    }
+
+    QCOMPARE(model.idAtSlot(slot), id);
+}
+
+// Lookup plus the repaint of the previous and new highlighted plates
+void BenchmarksTest::highlightParcel()
+{
+    BasicCarousel carousel(QRect(0, 0, 1900, 150), LOOKUP_BUCKETS);
+    CarouselModel* model = carousel.model();
+    QVector<QString> parcels;
+
+    for (int id = 0; id < LOOKUP_BUCKETS; id++)
+    {
+        parcels.append(parcelName(id));
+        model->assignParcel(parcels.last(), id);
+    }
+
+    model->setPosition(1234);
+
+    int parcel = 0;
+
+    QBENCHMARK
+    {
+        QVERIFY(carousel.highlightParcel(parcels[parcel]));
+        parcel = (parcel + 7919) % LOOKUP_BUCKETS;
+    }
+}
+
+// "Inhibit outputs 40-120" on the four lines of 500 outputs, alternating with the enable
+// of the same outputs : one pass per line, one notification, then the single repaint
+void BenchmarksTest::bulkInhibition()
+{
+    ConveyorModel model(WALL_OUTPUTS);
+    OutputWall wall(&model);
+    wall.resize(4*WALL_OUTPUTS, 200);
+
+    // 4 pixels per cell : the repainted band is exact
+    const QRect dirty(4*INHIBIT_FIRST, 0, 4*(INHIBIT_LAST - INHIBIT_FIRST + 1), wall.height());
+    QImage image(wall.size(), QImage::Format_ARGB32_Premultiplied);
+    bool inhibit = true;
+
+    QBENCHMARK
+    {
+        const OutputTrayState state = inhibit ? OutputTrayState::INHIBITED_U : OutputTrayState::ENABLED;
+
+        for (ConveyorLevel level : { ConveyorLevel::UPPER, ConveyorLevel::LOWER })
+        {
+            for (ConveyorSide side : { ConveyorSide::BACK, ConveyorSide::FRONT })
+                model.setOutputStateRange(level, side, INHIBIT_FIRST, INHIBIT_LAST, state);
+        }
+
+        QCoreApplication::sendPostedEvents();
+        wall.render(&image, dirty.topLeft(), QRegion(dirty));
+        inhibit = !inhibit;
+    }
+
+    QCOMPARE(model.outputState(INHIBIT_FIRST), inhibit ? OutputTrayState::ENABLED : OutputTrayState::INHIBITED_U);
+}
+
+// Same change through one OutputTray widget per output, the view before OutputWall
+void BenchmarksTest::trayInhibition()
+{
+    QWidget parent;
+    QVector<OutputTray*> trays;
+
+    for (int i = 0; i < 4*WALL_OUTPUTS; i++)
+        trays.append(new OutputTray(&parent, i % WALL_OUTPUTS));
+
+    bool inhibit = true;
+
+    QBENCHMARK
+    {
+        const OutputTrayState state = inhibit ? OutputTrayState::INHIBITED_U : OutputTrayState::ENABLED;
+
+        for (int line = 0; line < 4; line++)
+        {
+            for (int i = INHIBIT_FIRST; i <= INHIBIT_LAST; i++)
+                trays[line*WALL_OUTPUTS + i]->setState(state);
+        }
+
+        QCoreApplication::sendPostedEvents();
+        inhibit = !inhibit;
+    }
+}
+
+void BenchmarksTest::clickWiring_data()
+{
+    QTest::addColumn<bool>("dispatcher");
+
+    QTest::newRow("connection per plate") << false;
+    QTest::newRow("dispatcher")           << true;
+}
+
+// Click wiring of 2000 plates set up and torn down, the rest of the carousel left out :
+// one connection per plate as before BucketClickDispatcher, or one filter per line
+void BenchmarksTest::clickWiring()
+{
+    QFETCH(bool, dispatcher);
+
+    QWidget line;
+    QVector<QWidget*> cells;
+
+    for (int i = 0; i < CLICK_BUCKETS; i++)
+        cells.append(new BucketPlate(&line));
+
+    QBENCHMARK
+    {
+        QObject receiver;
+
+        if (dispatcher)
+        {
+            BucketClickDispatcher* clicks = new BucketClickDispatcher([](QWidget*) { return 0; }, &receiver);
+            clicks->addLine(&line, cells, ConveyorSide::FRONT, ConveyorLevel::UPPER);
+            QObject::connect(clicks, &BucketClickDispatcher::bucketClicked, &receiver, [](int) {});
+        }
+        else
+        {
+            for (QWidget* cell : qAsConst(cells))
+                QObject::connect(static_cast<BucketPlate*>(cell), &BucketPlate::clickReleased, &receiver, [](int) {});
+        }
+    }
+}
+
+void BenchmarksTest::constructCarousel()
+{
+    BasicCarousel* carousel = nullptr;
+
+    QBENCHMARK_ONCE
+    {
+        carousel = new BasicCarousel(QRect(0, 0, 1900, 150), CLICK_BUCKETS);
+    }
+
+    delete carousel;
+}
+
+void BenchmarksTest::destroyCarousel()
+{
+    BasicCarousel* carousel = new BasicCarousel(QRect(0, 0, 1900, 150), CLICK_BUCKETS);
+
+    QBENCHMARK_ONCE
+    {
+        delete carousel;
+    }
+}
+
+// One frame of a live window drag at 2000 buckets : the resize, the stretched picture of
+// the synoptic and the repaint, the width sweeping back and forth by 10 pixels. Then the
+// single relayout once the drag stops, timed up to the plates being shown again
+void BenchmarksTest::resizeDrag()
+{
+    BasicCarousel carousel(QRect(0, 0, 1900, 150), CLICK_BUCKETS);
+    carousel.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&carousel));
+
+    int width = carousel.width();
+    int step = -10;
+
+    QBENCHMARK
+    {
+        if (width + step < 1400 || width + step > 1900)
+            step = -step;
+
+        width += step;
+        carousel.resize(width, carousel.height());
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::LayoutRequest);
+        carousel.repaint();
+    }
+
+    QCOMPARE(carousel.width(), width);
+
+    // The plates stay hidden behind the picture until the drag stops
+    const BucketPlate* plate = carousel.findChild<BucketPlate*>();
+    QVERIFY(plate != nullptr);
+    QVERIFY(!plate->isVisible());
+
+    QElapsedTimer timer;
+    timer.start();
+    QTRY_VERIFY(plate->isVisible());
+    carousel.repaint();
+
+    qInfo() << "resize settled in" << timer.elapsed() << "ms, the quiet period included";
+}
+
+void BenchmarksTest::stateStyle_data()
+{
+    QTest::addColumn<bool>("table");
+
+    QTest::newRow("parsed colours (before)") << false;
+    QTest::newRow("packed table (after)")    << true;
+}
+
+// Colour and style sheet of 2000 output trays, the part of setState the tables replaced
+void BenchmarksTest::stateStyle()
+{
+    QFETCH(bool, table);
+
+    QColor color;
+    QString styleSheet;
+    int state = 0;
+
+    QBENCHMARK
+    {
+        for (int i = 0; i < STATE_TRAYS; i++)
+        {
+            const OutputTrayState trayState = static_cast<OutputTrayState>(state);
+
+            if (table)
+            {
+                color = QColor::fromRgba(StatePalette::output(trayState));
+                styleSheet = TABLE_STYLE;
+            }
+            else
+                legacyOutputStyle(trayState, i == STATE_TRAYS - 1, color, styleSheet);
+
+            state = (state + 1) % OUTPUT_TRAY_STATE_COUNT;
+        }
+    }
+
+    QVERIFY(color.isValid());
+}
+
+// Whole OutputTray::setState on 2000 hidden trays, style sheet application included
+void BenchmarksTest::setStateThroughput()
+{
+    QWidget parent;
+    QVector<OutputTray*> trays;
+
+    for (int i = 0; i < STATE_TRAYS; i++)
+        trays.append(new OutputTray(&parent, i));
+
+    int state = 0;
+
+    QBENCHMARK
+    {
+        for (OutputTray* tray : qAsConst(trays))
+        {
+            tray->setState(static_cast<OutputTrayState>(state));
+            state = (state + 1) % OUTPUT_TRAY_STATE_COUNT;
+        }
+    }
+}
+
+// Not a QBENCHMARK : the load is the process CPU time, render pool included, over a few
+// seconds of real time with 6 sorters of 800 buckets updated 20 times a second
+void BenchmarksTest::dashboardLoad()
+{
+    CarouselDashboard dashboard;
+    dashboard.resize(1600, 900);
+    QVector<CarouselModel*> models;
+
+    for (int i = 0; i < DASHBOARD_CAROUSELS; i++)
+    {
+        models.append(new CarouselModel(DASHBOARD_BUCKETS, &dashboard));
+        dashboard.addCarousel(models.last(), QString("Sorter %1").arg(i + 1));
+    }
+
+    dashboard.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&dashboard));
+
+    // One bucket in a hundred changes at each update, as with the gateway writer
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> bucket(0, DASHBOARD_BUCKETS - 1);
+    std::uniform_int_distribution<int> state(0, static_cast<int>(BucketState::FAILURE));
+
+    QTimer updates;
+    updates.setInterval(1000/DASHBOARD_RATE);
+    connect(&updates, &QTimer::timeout, this, [&]()
+    {
+        for (CarouselModel* model : qAsConst(models))
+        {
+            for (int i = 0; i < DASHBOARD_BUCKETS/100 + 1; i++)
+                model->setState(bucket(generator), static_cast<BucketState>(state(generator)));
+
+            model->setPosition(model->position() + 1);
+        }
+    });
+
+    const quint64 renders = dashboard.renderCount();
+    const std::clock_t cpuStart = std::clock();
+    QElapsedTimer wall;
+    wall.start();
+
+    updates.start();
+    QTest::qWait(DASHBOARD_SECONDS*1000);
+    updates.stop();
+
+    const double cpuMs = double(std::clock() - cpuStart)*1000/CLOCKS_PER_SEC;
+    const double wallMs = qMax<double>(wall.elapsed(), 1);
+
+    qInfo().nospace() << DASHBOARD_CAROUSELS << " x " << DASHBOARD_BUCKETS << " buckets at " << DASHBOARD_RATE << " Hz: "
+                      << cpuMs/wallMs*100 << "% of a core, " << (dashboard.renderCount() - renders)*1000/wallMs << " renders/s";
+
+    QVERIFY(dashboard.renderCount() > renders);
+}
+
+// Not a QBENCHMARK : the wakeups per second of a shown carousel, moving at 20 Hz then
+// stopped, as recorded by the meter. Stopped, the watchdog pings once a second
+void BenchmarksTest::idleWakeups()
+{
+    BasicCarousel carousel(QRect(0, 0, 1900, 150), WAKEUP_BUCKETS);
+    CarouselModel* model = carousel.model();
+
+    // Past the end of the demo rotation, which then stops its timer
+    model->setPosition(1000);
+
+    carousel.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&carousel));
+
+    QTemporaryFile wakeups;
+    QTemporaryFile stalls;
+    QVERIFY(wakeups.open() && stalls.open());
+
+    WakeupMeter meter(model, wakeups.fileName());
+    meter.setPeriod(WAKEUP_PERIOD);
+
+    StallWatchdog watchdog(model, stalls.fileName());
+    watchdog.start();
+
+    QTimer rotation;
+    rotation.setInterval(50);
+    connect(&rotation, &QTimer::timeout, this, [model]() { model->setPosition(model->position() + 1); });
+
+    rotation.start();
+    QTest::qWait(WAKEUP_PHASE);
+    rotation.stop();
+
+    QTest::qWait(WAKEUP_SETTLE);
+    const quint64 pings = watchdog.pingCount();
+    QTest::qWait(WAKEUP_PHASE);
+
+    const quint64 idlePings = watchdog.pingCount() - pings;
+    QVERIFY(idlePings >= 1 && idlePings <= quint64(WAKEUP_PHASE/1000 + 1));
+
+    // Back to the fast rate from the first rotation on
+    const quint64 rotationPings = watchdog.pingCount();
+    model->setPosition(model->position() + 1);
+    QTest::qWait(300);
+    QVERIFY(watchdog.pingCount() - rotationPings >= 3);
+    watchdog.stop();
+
+    // seconds,mode,timers_per_s,frames_per_s
+    QHash<QString, QPair<double, double>> rates;
+    QHash<QString, int> periods;
+    QTextStream in(&wakeups);
+    in.readLine();
+
+    while (!in.atEnd())
+    {
+        const QStringList fields = in.readLine().split(',');
+
+        if (fields.size() != 4)
+            continue;
+
+        rates[fields[1]].first  += fields[2].toDouble();
+        rates[fields[1]].second += fields[3].toDouble();
+        periods[fields[1]]++;
+    }
+
+    QVERIFY(periods.value("moving") > 0 && periods.value("stopped") > 0);
+
+    for (const QString& mode : { QString("moving"), QString("stopped") })
+        qInfo().nospace() << mode << " : " << rates[mode].first/periods[mode] << " timer events/s, "
+                          << rates[mode].second/periods[mode] << " frames/s over " << periods[mode] << " periods";
+}
+
+// Every bucket of a 500-bucket carousel changed at once, up to three views of the shared
+// CarouselModel rendered : the carousel views are notified synchronously, one range per change
+void BenchmarksTest::propagation()
+{
+    QVector<BasicCarousel*> views;
+
+    for (int i = 0; i < PROPAGATION_VIEWS; i++)
+    {
+        views.append(new BasicCarousel(QRect(0, 0, 1900, 150), PROPAGATION_BUCKETS));
+        views.last()->setModel(views.first()->model());
+    }
+
+    CarouselModel* model = views.first()->model();
+    QVector<quint8> states[2] = { QVector<quint8>(PROPAGATION_BUCKETS, static_cast<quint8>(BucketState::SORTED)),
+                                  QVector<quint8>(PROPAGATION_BUCKETS, static_cast<quint8>(BucketState::EMPTY)) };
+
+    // Known states instead of the random ones of the demo, past the end of its rotation
+    model->setStates(states[1], 1000);
+
+    int notifications = 0;
+    connect(model, &CarouselModel::bucketsChanged, this, [&notifications]() { notifications++; });
+
+    QImage image(views.first()->size(), QImage::Format_ARGB32_Premultiplied);
+    int turn = 0;
+
+    QBENCHMARK
+    {
+        notifications = 0;
+        model->applyStates(0, states[turn].constData(), PROPAGATION_BUCKETS, model->position());
+
+        for (BasicCarousel* view : qAsConst(views))
+            view->render(&image);
+
+        turn = 1 - turn;
+    }
+
+    QCOMPARE(notifications, 1);
+
+    qDeleteAll(views);
+}
+
+// The mask of each ConveyorModel batch is the one of its range only
+void BenchmarksTest::conveyorMasks()
+{
+    ConveyorModel conveyor(WALL_OUTPUTS);
+    QVector<QVector<int>> batches;
+
+    connect(&conveyor, &ConveyorModel::containersChanged, this, [&batches](int first, int last, int fields)
+    {
+        batches.append(QVector<int>{ first, last, fields });
+    });
+
+    // Whole snapshot, then a few containers ejected in the same turn
+    conveyor.setContainerStates(QVector<quint8>(conveyor.trayCount(), static_cast<quint8>(ContainerTrayState::EMPTY)),
+                                QVector<quint8>(conveyor.trayCount(), 0));
+    conveyor.setTrayId(ConveyorLevel::UPPER, ConveyorSide::BACK, 10, "T10");
+    conveyor.setTrayId(ConveyorLevel::UPPER, ConveyorSide::BACK, 11, "T11");
+
+    QTRY_VERIFY(!batches.isEmpty());
+
+    const int snapshot = FIELD_CONTAINER_STATE | FIELD_CONTAINER_RESERVE;
+    const QVector<QVector<int>> expected = { { 0, 9, snapshot },
+                                             { 10, 11, snapshot | FIELD_CONTAINER_TRAY_ID },
+                                             { 12, conveyor.trayCount() - 1, snapshot } };
+    QCOMPARE(batches, expected);
+}
+
+void BenchmarksTest::gatewayLatency_data()
+{
+    QTest::addColumn<int>("changed");
+
+    QTest::newRow("1% changed")   << GATEWAY_BUCKETS/100;
+    QTest::newRow("all changed")  << GATEWAY_BUCKETS;
+}
+
+// Gateway publication to model update through the shared segment : seqlock write, slot
+// copy, diff and notification. Both ends in this process, the frame wait is not counted
+void BenchmarksTest::gatewayLatency()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("POSIX shared memory only");
+#endif
+    QFETCH(int, changed);
+
+    const QByteArray name = "/carousel_benchmark_" + QByteArray::number(QCoreApplication::applicationPid());
+    SharedBucketWriter writer;
+    QVERIFY(writer.create(name.constData(), GATEWAY_BUCKETS));
+
+    CarouselModel model(GATEWAY_BUCKETS);
+    SharedBucketReader reader(&model);
+    QVERIFY(reader.attach(name.constData()));
+
+    // Two publications differing by the changed buckets, spread over the carousel
+    QVector<quint8> states[2] = { QVector<quint8>(GATEWAY_BUCKETS, static_cast<quint8>(BucketState::EMPTY)),
+                                  QVector<quint8>(GATEWAY_BUCKETS, static_cast<quint8>(BucketState::EMPTY)) };
+
+    for (int i = 0; i < changed; i++)
+        states[1][i*GATEWAY_BUCKETS/changed] = static_cast<quint8>(BucketState::SORTED);
+
+    int bcsPosition = 0;
+    int turn = 1;
+
+    QBENCHMARK
+    {
+        writer.publish(states[turn].constData(), ++bcsPosition);
+        QVERIFY(reader.poll());
+        turn = 1 - turn;
+    }
+
+    QCOMPARE(model.states(), states[1 - turn]);
+    QCOMPARE(model.position(), bcsPosition);
+    qInfo() << "worst latency:" << reader.maxLatency() << "us";
+
+    reader.detach();
+    writer.close();
+}
+
+// Cost of TransitionRecorder::record per event, the best of a few passes. Not a QBENCHMARK
+// loop : its iterations would fill the ring faster than the 20 ms drain and time the drop path
+void BenchmarksTest::transitionRecord()
+{
+    QTemporaryFile log;
+    QVERIFY(log.open());
+    log.close();
+
+    TransitionRecorder recorder;
+    qint64 best = std::numeric_limits<qint64>::max();
+    QElapsedTimer timer;
+
+    for (int pass = 0; pass < RECORD_PASSES; pass++)
+    {
+        QVERIFY(recorder.open(log.fileName()));
+
+        timer.start();
+
+        for (int i = 0; i < RECORD_EVENTS; i++)
+            recorder.record(i, (i*7919) % 2000, quint8(i % 5), quint8((i + 1) % 5));
+
+        best = qMin(best, timer.nsecsElapsed());
+
+        QCOMPARE(recorder.droppedRecords(), quint64(0));
+        recorder.close();
+    }
+
+    QTest::setBenchmarkResult(qreal(best)/RECORD_EVENTS, QTest::WalltimeNanoseconds);
+
+    // Ids above 16 bits would be truncated into other buckets
+    QVERIFY(recorder.open(log.fileName()));
+    recorder.record(0, TRANSITION_MAX_BUCKET + 1, 0, 1);
+    recorder.record(0, -1, 0, 1);
+    QCOMPARE(recorder.rejectedRecords(), quint64(2));
+    recorder.close();
+    QCOMPARE(log.size(), qint64(sizeof(TransitionLogHeader)));
+}
+
+// Seek to a random instant of a full shift of 2000 buckets, simulated on a fake clock : 10
+// rotation steps and 50 transitions a second for 8 hours
+void BenchmarksTest::historySeek()
+{
+    CarouselModel model(HISTORY_BUCKETS);
+    CarouselHistory history(&model);
+    qint64 clock = QDateTime::currentMSecsSinceEpoch();
+    history.setClock([&clock]() { return clock; });
+
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> bucket(0, HISTORY_BUCKETS - 1);
+    std::uniform_int_distribution<int> state(0, static_cast<int>(BucketState::FAILURE));
+
+    for (const qint64 end = clock + HISTORY_SHIFT; clock < end; clock += HISTORY_STEP)
+    {
+        model.setPosition(model.position() + 1);
+
+        for (int i = 0; i < HISTORY_TRANSITIONS; i++)
+            model.setState(bucket(generator), static_cast<BucketState>(state(generator)));
+    }
+
+    // The whole shift is kept within the budget, but for the checkpoint trimmed at the edge
+    QVERIFY(history.lastTimestamp() - history.firstTimestamp() >= HISTORY_SHIFT - 2*60*1000);
+    QVERIFY(history.memoryUsage() <= HISTORY_BUDGET);
+    qInfo() << "history of" << HISTORY_SHIFT/3600000 << "h:" << history.memoryUsage()/1024 << "KiB";
+
+    QVector<quint8> states;
+    int bcsPosition = 0;
+
+    QVERIFY(history.stateAt(history.lastTimestamp(), states, bcsPosition));
+    QCOMPARE(states, model.states());
+    QCOMPARE(bcsPosition, model.position());
+
+    std::uniform_int_distribution<qint64> instant(history.firstTimestamp(), history.lastTimestamp());
+
+    QBENCHMARK
+    {
+        history.stateAt(instant(generator), states, bcsPosition);
+    }
+}
+
+// F10 shift report : the frames rebuilt from the history, rendered at 1920 px and written
+// as PNG by the pool, up to the finished signal
+void BenchmarksTest::exportSynoptics()
+{
+    CarouselModel model(HISTORY_BUCKETS);
+    CarouselHistory history(&model);
+    qint64 clock = QDateTime::currentMSecsSinceEpoch();
+    history.setClock([&clock]() { return clock; });
+
+    std::mt19937 generator(11);
+    std::uniform_int_distribution<int> bucket(0, HISTORY_BUCKETS - 1);
+    std::uniform_int_distribution<int> state(0, static_cast<int>(BucketState::FAILURE));
+
+    for (const qint64 end = clock + EXPORT_FRAMES*EXPORT_STEP; clock < end; clock += HISTORY_STEP)
+    {
+        model.setPosition(model.position() + 1);
+
+        for (int i = 0; i < HISTORY_TRANSITIONS; i++)
+            model.setState(bucket(generator), static_cast<BucketState>(state(generator)));
+    }
+
+    QVector<qint64> timestamps;
+    for (qint64 time = history.lastTimestamp() - (EXPORT_FRAMES - 1)*EXPORT_STEP; time <= history.lastTimestamp(); time += EXPORT_STEP)
+        timestamps.append(time);
+
+    // The forward replay matches a seek per instant
+    QVector<quint8> states;
+    int bcsPosition = 0;
+    int mismatches = 0;
+
+    QCOMPARE(history.statesAt(timestamps, [&](qint64 timestamp, const QVector<quint8>& replayed, int replayedPosition)
+    {
+        if (!history.stateAt(timestamp, states, bcsPosition) || states != replayed || bcsPosition != replayedPosition)
+            mismatches++;
+    }), EXPORT_FRAMES);
+    QCOMPARE(mismatches, 0);
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    SynopticExporter exporter(&history);
+    QCOMPARE(exporter.size().width(), EXPORT_WIDTH);
+    QSignalSpy finished(&exporter, &SynopticExporter::finished);
+
+    QElapsedTimer timer;
+    timer.start();
+    int runs = 0;
+
+    QBENCHMARK
+    {
+        QVERIFY(exporter.start(timestamps, directory.path(), SynopticExporter::PNG));
+        QVERIFY(finished.wait(60000));
+        QCOMPARE(finished.takeFirst().at(0).toInt(), EXPORT_FRAMES);
+        runs++;
+    }
+
+    qInfo() << "export:" << runs*EXPORT_FRAMES*1000/qMax<qint64>(timer.elapsed(), 1) << "frames/s at" << EXPORT_WIDTH << "px";
+}
+
+static QVector<quint8> randomStates(std::mt19937& generator, int size, int stateCount)
+{
+    std::uniform_int_distribution<int> state(0, stateCount - 1);
+    QVector<quint8> states(size);
+
+    for (quint8& value : states)
+        value = quint8(state(generator));
+
+    return states;
+}
+
+// Save of a 10,000 buckets carousel and the walls, first into a missing directory (the
+// write fails and is retried), then restore into fresh models
+void BenchmarksTest::snapshotRoundTrip()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString fileName = directory.filePath("later/conveyor.snapshot");
+
+    std::mt19937 generator(13);
+
+    CarouselModel model(RESTORE_BUCKETS);
+    model.setStates(randomStates(generator, RESTORE_BUCKETS, BUCKET_STATE_COUNT), 4321);
+
+    ConveyorModel conveyor(WALL_OUTPUTS);
+    QVERIFY(conveyor.setOutputStates(randomStates(generator, conveyor.outputStates().size(), OUTPUT_TRAY_STATE_COUNT)));
+    QVERIFY(conveyor.setContainerStates(randomStates(generator, conveyor.containerStates().size(), CONTAINER_TRAY_STATE_COUNT),
+                                        randomStates(generator, conveyor.reserves().size(), 2)));
+    {
+        ConveyorSnapshot snapshot(fileName);
+        snapshot.addCarousel(&model);
+        snapshot.setConveyorModel(&conveyor);
+
+        QSignalSpy written(&snapshot, &ConveyorSnapshot::written);
+        snapshot.start();
+
+        QVERIFY(written.wait(10000));
+        QCOMPARE(written.takeFirst().at(0).toBool(), false);
+
+        QVERIFY(QDir().mkpath(directory.filePath("later")));
+        QVERIFY(written.wait(10000));
+        QCOMPARE(written.takeFirst().at(0).toBool(), true);
+    }
+
+    CarouselModel restoredModel(RESTORE_BUCKETS);
+    ConveyorModel restoredConveyor(WALL_OUTPUTS);
+    ConveyorSnapshot restored(fileName);
+    restored.addCarousel(&restoredModel);
+    restored.setConveyorModel(&restoredConveyor);
+
+    QVERIFY(restored.restore());
+    QCOMPARE(restoredModel.states(), model.states());
+    QCOMPARE(restoredModel.position(), model.position());
+    QCOMPARE(restoredConveyor.outputStates(), conveyor.outputStates());
+    QCOMPARE(restoredConveyor.containerStates(), conveyor.containerStates());
+    QCOMPARE(restoredConveyor.reserves(), conveyor.reserves());
+
+    QBENCHMARK
+    {
+        restored.restore();
+    }
+}
+
+// Full telegram of the sorter, see the layout in TelegramDecoder.h
+static QByteArray telegram(int bcsPosition, const QVector<quint8>& states)
+{
+    const int count = states.size();
+    QByteArray frame(TELEGRAM_HEADER_SIZE + (count + 1)/2 + 1, '\0');
+    uchar* data = reinterpret_cast<uchar*>(frame.data());
+
+    qToLittleEndian<quint16>(TELEGRAM_MAGIC, data);
+    qToLittleEndian<quint16>(quint16(frame.size()), data + 2);
+    qToLittleEndian<qint32>(bcsPosition, data + 4);
+    qToLittleEndian<quint16>(0, data + 8);
+    qToLittleEndian<quint16>(quint16(count), data + 10);
+
+    for (int i = 0; i < count; i++)
+        data[TELEGRAM_HEADER_SIZE + i/2] |= quint8(states[i] << (i % 2 ? 4 : 0));
+
+    quint8 checksum = 0;
+
+    for (int i = 0; i < frame.size() - 1; i++)
+        checksum ^= data[i];
+
+    data[frame.size() - 1] = checksum;
+    return frame;
+}
+
+// Decoding throughput on a synthetic capture of full telegrams, reported in frames/s
+void BenchmarksTest::telegramCapture()
+{
+    std::mt19937 generator(17);
+    QTemporaryFile capture;
+    QVERIFY(capture.open());
+
+    for (int i = 0; i < TELEGRAM_FRAMES; i++)
+        capture.write(telegram(i, randomStates(generator, TELEGRAM_BUCKETS, BUCKET_STATE_COUNT)));
+
+    capture.close();
+
+    CarouselModel model(TELEGRAM_BUCKETS);
+    TelegramDecoder decoder(&model);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QBENCHMARK
+    {
+        QVERIFY(decoder.decodeCapture(capture.fileName()));
+    }
+
+    const qint64 elapsed = qMax<qint64>(timer.nsecsElapsed(), 1);
+    QCOMPARE(decoder.frameCount() % TELEGRAM_FRAMES, quint64(0));
+    QCOMPARE(decoder.errorCount(), quint64(0));
+    qInfo() << "telegrams:" << decoder.frameCount()*1000000000/quint64(elapsed) << "frames/s";
+}
+
+// Paint events delivered to any widget of the application
+class PaintCounter : public QObject
+{
+public:
+    int count = 0;
+
+    bool eventFilter(QObject* watched, QEvent* event) override
+    {
+        if (event->type() == QEvent::Paint)
+            count++;
+
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+void BenchmarksTest::paintProfiler_data()
+{
+    QTest::addColumn<bool>("profiled");
+
+    QTest::newRow("off") << false;
+    QTest::newRow("on")  << true;
+}
+
+// PAINT_PROFILE against a full carousel frame. The default build compiles the scopes out,
+// so "on" adds to each frame one PaintProfileScope per paint event the frame delivered,
+// which is the whole work of the macro
+void BenchmarksTest::paintProfiler()
+{
+    QFETCH(bool, profiled);
+
+    BasicCarousel carousel(QRect(0, 0, 1900, 150), CLICK_BUCKETS);
+    QImage image(carousel.size(), QImage::Format_ARGB32_Premultiplied);
+
+    PaintCounter counter;
+    qApp->installEventFilter(&counter);
+    carousel.render(&image);
+    qApp->removeEventFilter(&counter);
+
+    const int paints = counter.count;
+    const QRect area(0, 0, 40, 40);
+    QVERIFY(paints > 0);
+
+    QBENCHMARK
+    {
+        carousel.render(&image);
+
+        for (int i = 0; profiled && i < paints; i++)
+            PaintProfileScope scope("BenchmarkPlate", area);
+    }
+
+    if (profiled)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        for (int i = 0; i < PROFILER_FRAMES; i++)
+            carousel.render(&image);
+
+        const qint64 frameNs = timer.nsecsElapsed()/PROFILER_FRAMES;
+        timer.restart();
+
+        for (int i = 0; i < PROFILER_FRAMES*paints; i++)
+            PaintProfileScope scope("BenchmarkPlate", area);
+
+        const qint64 profileNs = timer.nsecsElapsed()/PROFILER_FRAMES;
+
+        qInfo() << "paint profiler:" << paints << "scopes per frame," << profileNs*100.0/frameNs << "% of" << frameNs/1000 << "us";
+        QVERIFY(profileNs*PROFILER_BUDGET < frameNs);
+    }
+
+    PaintProfiler::reset();
+}
+
+// Shift-click over 10,000 items then a plain click back : two whole ranges set and
+// cleared a word at a time, one notification each
+void BenchmarksTest::rangeSelection()
+{
+    SelectionModel selection(SELECTION_ITEMS);
+    QSignalSpy changed(&selection, &SelectionModel::selectionChanged);
+
+    selection.click(3, Qt::NoModifier);
+
+    QBENCHMARK
+    {
+        selection.click(SELECTION_ITEMS - 5, Qt::ShiftModifier);
+        selection.click(3, Qt::NoModifier);
+    }
+
+    selection.click(SELECTION_ITEMS - 5, Qt::ShiftModifier);
+    QCOMPARE(selection.count(), SELECTION_ITEMS - 7);
+    QCOMPARE(changed.last().at(1).toInt(), SELECTION_ITEMS - 5);
+}
+
+// The offscreen platform is enough, even for the shown windows : no display is needed
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication application(argc, argv);
+    BenchmarksTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "tst_benchmarks.moc"
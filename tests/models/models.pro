@@ -0,0 +1,6 @@
+TARGET = tst_models
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_models.cpp
@@ -0,0 +1,241 @@
+#include <QtTest>
+#include "SelectionModel.h"
+#include "IntervalSet.h"
+#include <climits>
+
+static const int SELECTION_ITEMS = 200;
+static const int BLOCK_CELLS     = 10;        // per line of the selectBlock grids
+
+static QVariantList range(int first, int last)
+{
+    return QVariantList{first, last};
+}
+
+//---------------------------------------------------------------------------------------
+// class ModelsTest
+// Unit tests of the models shared by the views : the list semantics of SelectionModel
+// and the ranges it notifies, the merges and splits of IntervalSet and its cursor.
+//---------------------------------------------------------------------------------------
+
+class ModelsTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void selectionClick();
+    void selectionBlock();
+    void intervalMerge();
+    void intervalSplit();
+    void intervalLimits();
+    void intervalCursor();
+};
+
+// Plain click, Shift extension from the anchor, Ctrl toggle and Ctrl+Shift addition
+void ModelsTest::selectionClick()
+{
+    SelectionModel selection(SELECTION_ITEMS);
+    QSignalSpy changed(&selection, &SelectionModel::selectionChanged);
+
+    selection.click(10, Qt::NoModifier);
+    QCOMPARE(selection.count(), 1);
+    QVERIFY(selection.isSelected(10));
+    QCOMPARE(selection.anchor(), 10);
+    QCOMPARE(changed.last(), range(10, 10));
+
+    // Shift keeps the anchor and replaces the selection
+    selection.click(20, Qt::ShiftModifier);
+    QCOMPARE(selection.count(), 11);
+    QCOMPARE(selection.nextSelected(0), 10);
+    QCOMPARE(selection.anchor(), 10);
+    QCOMPARE(changed.last(), range(10, 20));
+
+    selection.click(5, Qt::ShiftModifier);
+    QCOMPARE(selection.count(), 6);
+    QVERIFY(!selection.isSelected(11));
+    QCOMPARE(changed.last(), range(5, 20));
+
+    // Ctrl toggles one item and moves the anchor
+    selection.click(100, Qt::ControlModifier);
+    QCOMPARE(selection.count(), 7);
+    QCOMPARE(selection.anchor(), 100);
+    QCOMPARE(changed.last(), range(100, 100));
+
+    selection.click(5, Qt::ControlModifier);
+    QCOMPARE(selection.count(), 6);
+    QVERIFY(!selection.isSelected(5));
+    QCOMPARE(selection.anchor(), 5);
+
+    // Ctrl+Shift adds the range from the anchor to the selection
+    selection.click(110, Qt::ShiftModifier | Qt::ControlModifier);
+    QCOMPARE(selection.count(), 106);
+    QVERIFY(selection.isSelected(5) && selection.isSelected(110));
+    QCOMPARE(selection.nextSelected(111), -1);
+    QCOMPARE(changed.last(), range(5, 110));
+
+    // A plain click repaints the old selection with the new one
+    selection.click(50, Qt::NoModifier);
+    QCOMPARE(selection.count(), 1);
+    QCOMPARE(selection.nextSelected(0), 50);
+    QCOMPARE(changed.last(), range(5, 110));
+
+    // Out of range clicks change nothing
+    const int notified = changed.count();
+    selection.click(-1, Qt::NoModifier);
+    selection.click(SELECTION_ITEMS, Qt::ShiftModifier);
+    QCOMPARE(changed.count(), notified);
+    QCOMPARE(selection.count(), 1);
+}
+
+// Rubber band over a grid of BLOCK_CELLS items per line, clipped to the grid
+void ModelsTest::selectionBlock()
+{
+    SelectionModel selection(95);
+    QSignalSpy changed(&selection, &SelectionModel::selectionChanged);
+
+    selection.selectBlock(2, 4, 3, 5, BLOCK_CELLS, false);
+    QCOMPARE(selection.count(), 9);
+    QVERIFY(selection.isSelected(23) && selection.isSelected(35) && selection.isSelected(45));
+    QVERIFY(!selection.isSelected(26) && !selection.isSelected(32));
+    QCOMPARE(changed.last(), range(23, 45));
+
+    // Extended, the cells past the end of the line are clipped
+    selection.selectBlock(0, 0, 8, 20, BLOCK_CELLS, true);
+    QCOMPARE(selection.count(), 11);
+    QVERIFY(selection.isSelected(8) && selection.isSelected(9));
+    QCOMPARE(changed.last(), range(8, 9));
+
+    // Replaced, the last line is partial : 90 to 94
+    selection.selectBlock(9, 12, 0, 9, BLOCK_CELLS, false);
+    QCOMPARE(selection.count(), 5);
+    QCOMPARE(selection.nextSelected(0), 90);
+    QCOMPARE(changed.last(), range(8, 94));
+
+    // An empty block only clears
+    selection.selectBlock(5, 4, 0, 9, BLOCK_CELLS, false);
+    QCOMPARE(selection.count(), 0);
+    QCOMPARE(changed.last(), range(90, 94));
+
+    const int notified = changed.count();
+    selection.selectBlock(5, 4, 0, 9, BLOCK_CELLS, false);
+    QCOMPARE(changed.count(), notified);
+}
+
+static QVector<IntervalSet::Interval> allIntervals(const IntervalSet& set)
+{
+    return set.intervals(INT_MIN, INT_MAX);
+}
+
+// Adjacent and overlapping intervals are merged, a gap of one value is kept
+void ModelsTest::intervalMerge()
+{
+    IntervalSet set;
+
+    set.insert(1, 3);
+    set.insert(4, 6);
+    QCOMPARE(set.intervalCount(), 1);
+    QCOMPARE(set.count(), 6);
+
+    set.insert(8, 9);
+    QCOMPARE(set.intervalCount(), 2);
+    QVERIFY(!set.contains(7));
+
+    set.insert(7, 7);
+    QCOMPARE(allIntervals(set), QVector<IntervalSet::Interval>({{1, 9}}));
+    QCOMPARE(set.count(), 9);
+
+    // Overlapping several intervals at once, touching the first one from below
+    set.insert(20, 25);
+    set.insert(30, 31);
+    set.insert(0, 28);
+    QCOMPARE(allIntervals(set), QVector<IntervalSet::Interval>({{0, 28}, {30, 31}}));
+    QCOMPARE(set.count(), 31);
+
+    set.insert(5, 5);
+    set.insert(3, 2);
+    QCOMPARE(set.count(), 31);
+}
+
+// Removing the middle of an interval splits it, the ends are trimmed
+void ModelsTest::intervalSplit()
+{
+    IntervalSet set;
+    set.insert(10, 30);
+
+    set.remove(15, 19);
+    QCOMPARE(allIntervals(set), QVector<IntervalSet::Interval>({{10, 14}, {20, 30}}));
+    QCOMPARE(set.count(), 16);
+
+    set.remove(0, 10);
+    set.remove(30, 40);
+    QCOMPARE(allIntervals(set), QVector<IntervalSet::Interval>({{11, 14}, {20, 29}}));
+    QCOMPARE(set.count(), 14);
+
+    set.remove(12, 25);
+    QCOMPARE(allIntervals(set), QVector<IntervalSet::Interval>({{11, 11}, {26, 29}}));
+    QCOMPARE(set.count(), 5);
+
+    set.remove(0, 100);
+    QVERIFY(set.isEmpty());
+    QCOMPARE(set.count(), 0);
+
+    // Clipped to the requested window
+    set.insert(0, 9);
+    set.insert(20, 29);
+    QCOMPARE(set.intervals(5, 22), QVector<IntervalSet::Interval>({{5, 9}, {20, 22}}));
+}
+
+// Intervals ending at INT_MAX or starting at INT_MIN merge without overflow
+void ModelsTest::intervalLimits()
+{
+    IntervalSet set;
+
+    set.insert(INT_MAX - 1, INT_MAX);
+    set.insert(INT_MIN, INT_MIN + 1);
+    QCOMPARE(set.intervalCount(), 2);
+
+    set.insert(INT_MAX - 5, INT_MAX - 2);
+    set.insert(INT_MIN + 2, INT_MIN + 3);
+    QCOMPARE(allIntervals(set), QVector<IntervalSet::Interval>({{INT_MIN, INT_MIN + 3}, {INT_MAX - 5, INT_MAX}}));
+    QCOMPARE(set.count(), 10);
+
+    set.insert(INT_MAX, INT_MAX);
+    QCOMPARE(set.count(), 10);
+
+    set.remove(INT_MAX, INT_MAX);
+    set.remove(INT_MIN, INT_MIN);
+    QVERIFY(!set.contains(INT_MAX) && !set.contains(INT_MIN));
+    QVERIFY(set.contains(INT_MAX - 1) && set.contains(INT_MIN + 1));
+    QCOMPARE(set.count(), 8);
+}
+
+// Forward walks, then a backward jump as at the rotation wrap
+void ModelsTest::intervalCursor()
+{
+    IntervalSet set;
+    set.insert(5, 9);
+    set.insert(20, 24);
+    set.insert(40, 40);
+
+    IntervalSet::Cursor cursor(set);
+
+    for (int round = 0; round < 2; round++)
+    {
+        for (int value = 0; value < 50; value++)
+            QCOMPARE(cursor.contains(value), set.contains(value));
+    }
+
+    // Rewinds into the middle of an interval, and before the first one
+    QVERIFY(cursor.contains(22));
+    QVERIFY(cursor.contains(24));
+    QVERIFY(!cursor.contains(25));
+    QVERIFY(cursor.contains(7));
+    QVERIFY(!cursor.contains(3));
+    QVERIFY(cursor.contains(5));
+    QVERIFY(cursor.contains(40));
+    QVERIFY(!cursor.contains(INT_MAX));
+    QVERIFY(!cursor.contains(INT_MIN));
+}
+
+QTEST_GUILESS_MAIN(ModelsTest)
+
+#include "tst_models.moc"
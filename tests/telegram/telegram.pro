@@ -0,0 +1,6 @@
+TARGET = tst_telegram
+
+include(../tests.pri)
+
+SOURCES += \
+    tst_telegram.cpp
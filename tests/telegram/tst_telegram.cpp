@@ -0,0 +1,266 @@
+#include <QtTest>
+#include <QTemporaryFile>
+#include <QtEndian>
+#include <random>
+#include <vector>
+#include "TelegramDecoder.h"
+
+static const int TEST_BUCKETS = 600;
+static const int FUZZ_ROUNDS  = 2000;
+
+// A well-formed telegram, see the layout in TelegramDecoder.h
+static QByteArray telegram(int bcsPosition, int first, const QVector<quint8>& states)
+{
+    const int count = states.size();
+    QByteArray frame(TELEGRAM_HEADER_SIZE + (count + 1)/2 + 1, '\0');
+    uchar* data = reinterpret_cast<uchar*>(frame.data());
+
+    qToLittleEndian<quint16>(TELEGRAM_MAGIC, data);
+    qToLittleEndian<quint16>(quint16(frame.size()), data + 2);
+    qToLittleEndian<qint32>(bcsPosition, data + 4);
+    qToLittleEndian<quint16>(quint16(first), data + 8);
+    qToLittleEndian<quint16>(quint16(count), data + 10);
+
+    for (int i = 0; i < count; i++)
+        data[TELEGRAM_HEADER_SIZE + i/2] |= quint8(states[i] << (i % 2 ? 4 : 0));
+
+    quint8 checksum = 0;
+
+    for (int i = 0; i < frame.size() - 1; i++)
+        checksum ^= data[i];
+
+    data[frame.size() - 1] = checksum;
+    return frame;
+}
+
+static QVector<quint8> randomStates(std::mt19937& generator, int count)
+{
+    std::uniform_int_distribution<int> state(0, BUCKET_STATE_COUNT - 1);
+    QVector<quint8> states(count);
+
+    for (quint8& packed : states)
+        packed = quint8(state(generator));
+
+    return states;
+}
+
+// Exactly sized copy : a read past the end is caught by the sanitizers
+static int feedExact(TelegramDecoder& decoder, const QByteArray& bytes)
+{
+    const std::vector<uchar> buffer(bytes.cbegin(), bytes.cend());
+    return decoder.feed(buffer.data(), int(buffer.size()));
+}
+
+//---------------------------------------------------------------------------------------
+// class TelegramTest
+// Decoding of well-formed telegrams, and fuzzing of TelegramDecoder::feed with random
+// and mutated frames : whatever the input, it consumes within the buffer and the model
+// only ever receives valid states.
+//---------------------------------------------------------------------------------------
+
+class TelegramTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void decodeFrames();
+    void splitFeed();
+    void fuzzRandom_data();
+    void fuzzRandom();
+    void fuzzMutated_data();
+    void fuzzMutated();
+    void decodeCapture();
+
+private:
+    void checkModel(const CarouselModel& model, int consumed, int size);
+};
+
+void TelegramTest::checkModel(const CarouselModel& model, int consumed, int size)
+{
+    QVERIFY(consumed >= 0 && consumed <= size);
+    QCOMPARE(model.bucketCount(), TEST_BUCKETS);
+
+    for (quint8 packed : model.states())
+        QVERIFY(packed < BUCKET_STATE_COUNT);
+}
+
+void TelegramTest::decodeFrames()
+{
+    std::mt19937 generator(1);
+    CarouselModel model(TEST_BUCKETS);
+    TelegramDecoder decoder(&model);
+
+    const QVector<quint8> head = randomStates(generator, 101);
+    const QVector<quint8> tail = randomStates(generator, TEST_BUCKETS - 300);
+    const QByteArray stream = "garbage" + telegram(17, 0, head) + "\x54\x53" + telegram(42, 300, tail);
+
+    QCOMPARE(feedExact(decoder, stream), stream.size());
+    QCOMPARE(decoder.frameCount(), quint64(2));
+    QCOMPARE(model.position(), 42);
+    QVERIFY(std::equal(head.cbegin(), head.cend(), model.states().cbegin()));
+    QVERIFY(std::equal(tail.cbegin(), tail.cend(), model.states().cbegin() + 300));
+}
+
+// Fed by random chunks, the unconsumed bytes carried over : same result as a single feed
+void TelegramTest::splitFeed()
+{
+    std::mt19937 generator(2);
+    QByteArray stream;
+
+    for (int i = 0; i < 50; i++)
+        stream += telegram(i, 0, randomStates(generator, TEST_BUCKETS));
+
+    CarouselModel whole(TEST_BUCKETS);
+    TelegramDecoder wholeDecoder(&whole);
+    feedExact(wholeDecoder, stream);
+
+    CarouselModel split(TEST_BUCKETS);
+    TelegramDecoder splitDecoder(&split);
+    std::uniform_int_distribution<int> chunk(1, 700);
+    QByteArray pending;
+    int offset = 0;
+
+    while (offset < stream.size())
+    {
+        const int length = qMin(chunk(generator), stream.size() - offset);
+        pending += stream.mid(offset, length);
+        offset += length;
+
+        pending.remove(0, feedExact(splitDecoder, pending));
+    }
+
+    QCOMPARE(splitDecoder.frameCount(), wholeDecoder.frameCount());
+    QCOMPARE(split.states(), whole.states());
+    QCOMPARE(split.position(), whole.position());
+}
+
+void TelegramTest::fuzzRandom_data()
+{
+    QTest::addColumn<quint32>("seed");
+
+    for (quint32 seed = 1; seed <= 4; seed++)
+        QTest::newRow(qPrintable(QString("seed %1").arg(seed))) << seed;
+}
+
+// Random bytes, with magics sown in so that the header checks are reached
+void TelegramTest::fuzzRandom()
+{
+    QFETCH(quint32, seed);
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> size(0, 4096);
+    std::bernoulli_distribution magic(0.02);
+
+    CarouselModel model(TEST_BUCKETS);
+    TelegramDecoder decoder(&model);
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++)
+    {
+        QByteArray bytes(size(generator), '\0');
+
+        for (int i = 0; i < bytes.size(); i++)
+        {
+            if (i + 1 < bytes.size() && magic(generator))
+            {
+                bytes[i++] = char(TELEGRAM_MAGIC & 0xFF);
+                bytes[i]   = char(TELEGRAM_MAGIC >> 8);
+            }
+            else
+                bytes[i] = char(byte(generator));
+        }
+
+        checkModel(model, feedExact(decoder, bytes), bytes.size());
+    }
+}
+
+void TelegramTest::fuzzMutated_data()
+{
+    fuzzRandom_data();
+}
+
+// Valid frames with flipped bytes, rewritten length or count fields, truncations and
+// duplications. Mutated frames that still pass the checksum must decode in bounds
+void TelegramTest::fuzzMutated()
+{
+    QFETCH(quint32, seed);
+
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<int> count(0, 2*TEST_BUCKETS);
+    std::uniform_int_distribution<int> first(0, 0xFFFF);
+    std::uniform_int_distribution<int> mutation(0, 5);
+
+    CarouselModel model(TEST_BUCKETS);
+    TelegramDecoder decoder(&model);
+
+    for (int round = 0; round < FUZZ_ROUNDS; round++)
+    {
+        const int states = count(generator);
+        QByteArray frame = telegram(round, first(generator) % (2*TEST_BUCKETS), randomStates(generator, states));
+        std::uniform_int_distribution<int> position(0, frame.size() - 1);
+
+        switch (mutation(generator))
+        {
+        case 0:     // flipped bytes
+            for (int i = 0; i < 4; i++)
+                frame[position(generator)] = char(byte(generator));
+            break;
+
+        case 1:     // length field
+            frame[2] = char(byte(generator));
+            frame[3] = char(byte(generator));
+            break;
+
+        case 2:     // count field, the checksum fixed so that the frame is decoded
+            frame[10] = char(byte(generator));
+            frame[11] = char(byte(generator) & 0x03);
+            frame[frame.size() - 1] = 0;
+            for (int i = 0; i < frame.size() - 1; i++)
+                frame[frame.size() - 1] = char(frame[frame.size() - 1] ^ frame[i]);
+            break;
+
+        case 3:     // truncated
+            frame.truncate(position(generator));
+            break;
+
+        case 4:     // duplicated into itself
+            frame.insert(position(generator), frame.left(position(generator)));
+            break;
+
+        default:    // untouched, out of range first ids included
+            break;
+        }
+
+        checkModel(model, feedExact(decoder, frame), frame.size());
+    }
+
+    QVERIFY(decoder.frameCount() > 0);
+    QVERIFY(decoder.errorCount() > 0);
+}
+
+void TelegramTest::decodeCapture()
+{
+    std::mt19937 generator(3);
+    QTemporaryFile capture;
+    QVERIFY(capture.open());
+
+    for (int i = 0; i < 200; i++)
+    {
+        capture.write(telegram(i, 0, randomStates(generator, TEST_BUCKETS)));
+        capture.write("\x00\x54", 2);
+    }
+
+    capture.close();
+
+    CarouselModel model(TEST_BUCKETS);
+    TelegramDecoder decoder(&model);
+
+    QVERIFY(decoder.decodeCapture(capture.fileName()));
+    QCOMPARE(decoder.frameCount(), quint64(200));
+    QCOMPARE(model.position(), 199);
+}
+
+QTEST_GUILESS_MAIN(TelegramTest)
+
+#include "tst_telegram.moc"
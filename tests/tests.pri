@@ -0,0 +1,7 @@
+# Test targets build the HMI sources with QtTest
+include($$PWD/../Carousel.pri)
+
+QT += testlib
+
+CONFIG += testcase console
+CONFIG -= app_bundle
@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+# Benchmarks of the HMI hot paths, unit and robustness tests, "make check" runs them all
+SUBDIRS += \
+    allocations \
+    benchmarks \
+    models \
+    telegram